@@ -14,11 +14,58 @@ SOURCES += \
         pdfsearchpanel.cpp \
     custom_widgets.cpp \
     librarysidebar.cpp \
-    pdfviewport.cpp
+    pdfviewport.cpp \
+    documentpool.cpp \
+    pagecache.cpp \
+    renderqueue.cpp \
+    diskcache.cpp \
+    thumbnailrenderer.cpp \
+    thumbnailview.cpp \
+    renderprofile.cpp \
+    tracer.cpp \
+    textindex.cpp \
+    libraryindex.cpp \
+    librarysearchview.cpp \
+    textmatcher.cpp
 
 HEADERS += \
         mainwindow.h \
         pdfsearchpanel.h \
     custom_widgets.h \
     librarysidebar.h \
-    pdfviewport.h
+    pdfviewport.h \
+    documentpool.h \
+    pagecache.h \
+    renderqueue.h \
+    diskcache.h \
+    thumbnailrenderer.h \
+    thumbnailview.h \
+    renderprofile.h \
+    tracer.h \
+    textindex.h \
+    libraryindex.h \
+    librarysearchview.h \
+    textmatcher.h
+
+# Бенчмарк рендера без окна: make bench, затем bench/render_bench <папка с PDF>
+bench.target = bench
+bench.CONFIG = phony
+bench.commands = $(MKDIR) bench && cd bench && $$QMAKE_QMAKE $$PWD/bench/render_bench.pro && $(MAKE)
+
+# Сценарий прокрутки вьюпорта: make replay, затем REPLAY_PDF=<файл> replay/viewport_replay
+replay.target = replay
+replay.CONFIG = phony
+replay.commands = $(MKDIR) replay && cd replay && $$QMAKE_QMAKE $$PWD/bench/viewport_replay.pro && $(MAKE)
+
+# Сравнение поиска Poppler и TextMatcher: make searchbench, затем searchbench/search_bench <папка с PDF>
+searchbench.target = searchbench
+searchbench.CONFIG = phony
+searchbench.commands = $(MKDIR) searchbench && cd searchbench && $$QMAKE_QMAKE $$PWD/bench/search_bench.pro && $(MAKE)
+
+# Проверки TextMatcher с SSE2 и без: make matchertest
+matchertest.target = matchertest
+matchertest.CONFIG = phony
+matchertest.commands = $(MKDIR) matchertest/simd matchertest/scalar \
+    && cd matchertest/simd && $$QMAKE_QMAKE $$PWD/bench/textmatcher_test.pro && $(MAKE) && ./textmatcher_test \
+    && cd ../scalar && $$QMAKE_QMAKE CONFIG+=nosimd $$PWD/bench/textmatcher_test.pro && $(MAKE) && ./textmatcher_test
+QMAKE_EXTRA_TARGETS += bench replay searchbench matchertest
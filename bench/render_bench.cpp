@@ -0,0 +1,230 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //render_bench.cpp
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QThreadPool>
+#include <QTextStream>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include "documentpool.h"
+#include "renderqueue.h"
+#include "tracer.h"
+
+// Рендер всех страниц набора PDF тем же кодом, что и во вьюпорте
+// (RenderQueue::render + DocumentPool), без окна. Результат — JSON.
+
+static QList<int> parseIntList(const QString &value) {
+    QList<int> result;
+    const QStringList parts = value.split(',', Qt::SkipEmptyParts);
+    for (const QString &part : parts) {
+        bool ok = false;
+        int v = part.trimmed().toInt(&ok);
+        if (ok && v > 0) result.append(v);
+    }
+    return result;
+}
+
+static QStringList collectFiles(const QStringList &inputs) {
+    QStringList files;
+    for (const QString &input : inputs) {
+        QFileInfo info(input);
+        if (info.isDir()) {
+            QDirIterator it(input, QStringList() << "*.pdf" << "*.PDF", QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) files.append(it.next());
+        } else if (info.isFile()) {
+            files.append(info.absoluteFilePath());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// Пиковый RSS процесса из /proc (только Linux). Запись "5" в clear_refs
+// сбрасывает пик, чтобы каждый прогон мерился отдельно.
+static void resetPeakRss() {
+    QFile f("/proc/self/clear_refs");
+    if (f.open(QIODevice::WriteOnly)) f.write("5");
+}
+
+static qint64 peakRssKB() {
+    QFile f("/proc/self/status");
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return -1;
+    const QList<QByteArray> lines = f.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        if (line.startsWith("VmHWM:")) {
+            return line.mid(6).trimmed().split(' ').value(0).toLongLong();
+        }
+    }
+    return -1;
+}
+
+static double percentile(const QVector<double> &sorted, double p) {
+    if (sorted.isEmpty()) return 0.0;
+    int rank = qBound(0, int(std::ceil(p / 100.0 * sorted.size())) - 1, sorted.size() - 1);
+    return sorted[rank];
+}
+
+struct PageTask {
+    int file = 0;
+    int page = 0;
+    QSizeF pageSize;
+};
+
+static QJsonObject runOnce(const QStringList &files, const QVector<PageTask> &tasks, int dpi, int threads) {
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(threads);
+    threadPool.setExpiryTimeout(-1);
+
+    QVector<QSharedPointer<DocumentPool>> pools;
+    for (const QString &file : files) pools.append(QSharedPointer<DocumentPool>::create(file));
+
+    QMutex latencyMutex;
+    QVector<double> latencies;
+    latencies.reserve(tasks.size());
+    QAtomicInt failed(0);
+
+    resetPeakRss();
+    QElapsedTimer wall;
+    wall.start();
+
+    QList<QFuture<void>> futures;
+    for (const PageTask &task : tasks) {
+        RenderJob job;
+        job.page = task.page;
+        job.quality = QualityHD;
+        job.dpr = 1.0;
+        job.targetSize = QSize(qRound(task.pageSize.width() * dpi / 72.0), qRound(task.pageSize.height() * dpi / 72.0));
+        DocumentPool *pool = pools[task.file].data();
+
+        futures.append(QtConcurrent::run(&threadPool, [job, pool, &latencyMutex, &latencies, &failed]() {
+            QElapsedTimer timer;
+            timer.start();
+            QImage img = RenderQueue::render(job, pool);
+            double ms = timer.nsecsElapsed() / 1e6;
+            if (img.isNull()) failed.fetchAndAddRelaxed(1);
+            QMutexLocker locker(&latencyMutex);
+            latencies.append(ms);
+        }));
+    }
+    for (QFuture<void> &f : futures) f.waitForFinished();
+
+    double seconds = wall.nsecsElapsed() / 1e9;
+    qint64 rss = peakRssKB();
+    pools.clear();
+
+    std::sort(latencies.begin(), latencies.end());
+    QJsonObject latency;
+    latency["p50"] = percentile(latencies, 50);
+    latency["p95"] = percentile(latencies, 95);
+    latency["p99"] = percentile(latencies, 99);
+    latency["max"] = latencies.isEmpty() ? 0.0 : latencies.last();
+
+    QJsonObject run;
+    run["dpi"] = dpi;
+    run["effectiveDpi"] = qMin(double(dpi), MAX_DPI);
+    run["threads"] = threads;
+    run["pages"] = tasks.size();
+    run["failedPages"] = failed.load();
+    run["seconds"] = seconds;
+    run["pagesPerSec"] = seconds > 0 ? tasks.size() / seconds : 0.0;
+    run["latencyMs"] = latency;
+    run["peakRssKB"] = rss;
+    return run;
+}
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("render_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless page render benchmark");
+    parser.addHelpOption();
+    parser.addPositionalArgument("inputs", "PDF files or directories (searched recursively).");
+    QCommandLineOption dpiOption("dpi", "Comma-separated DPI list.", "list", "72,150,300");
+    QCommandLineOption threadsOption("threads", "Comma-separated thread counts.", "list",
+                                     QString::number(QThread::idealThreadCount()));
+    QCommandLineOption pagesOption("max-pages", "Render at most N pages per file (0 = all).", "n", "0");
+    QCommandLineOption outOption("out", "Write JSON to file instead of stdout.", "file");
+    parser.addOption(dpiOption);
+    parser.addOption(threadsOption);
+    parser.addOption(pagesOption);
+    parser.addOption(outOption);
+    parser.process(app);
+
+    QStringList files = collectFiles(parser.positionalArguments());
+    QList<int> dpis = parseIntList(parser.value(dpiOption));
+    QList<int> threadCounts = parseIntList(parser.value(threadsOption));
+    int maxPages = parser.value(pagesOption).toInt();
+    if (files.isEmpty() || dpis.isEmpty() || threadCounts.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    QVector<PageTask> tasks;
+    QJsonArray fileList;
+    for (int i = 0; i < files.size(); ++i) {
+        DocumentPool pool(files[i]);
+        Poppler::Document *doc = pool.load();
+        if (!doc || doc->isLocked()) {
+            delete doc;
+            continue;
+        }
+        int pages = doc->numPages();
+        if (maxPages > 0) pages = qMin(pages, maxPages);
+        for (int p = 0; p < pages; ++p) {
+            Poppler::Page *page = doc->page(p);
+            if (!page) continue;
+            PageTask task;
+            task.file = i;
+            task.page = p;
+            task.pageSize = page->pageSizeF();
+            tasks.append(task);
+            delete page;
+        }
+        delete doc;
+
+        QJsonObject entry;
+        entry["path"] = files[i];
+        entry["pages"] = pages;
+        fileList.append(entry);
+    }
+
+    Tracer::start(Tracer::pathFromEnvironment(QStringList()));
+    QJsonArray runs;
+    for (int dpi : dpis) {
+        for (int threads : threadCounts) {
+            runs.append(runOnce(files, tasks, dpi, threads));
+        }
+    }
+    Tracer::stop();
+
+    QJsonObject report;
+    report["files"] = fileList;
+    report["runs"] = runs;
+    QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet(outOption)) {
+        QFile out(parser.value(outOption));
+        if (!out.open(QIODevice::WriteOnly)) return 2;
+        out.write(json);
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
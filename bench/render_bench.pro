@@ -0,0 +1,29 @@
+QT       += core gui concurrent
+
+TARGET = render_bench
+TEMPLATE = app
+
+CONFIG += c++11 console link_pkgconfig
+CONFIG -= app_bundle
+PKGCONFIG += poppler-qt5
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    render_bench.cpp \
+    ../documentpool.cpp \
+    ../pagecache.cpp \
+    ../renderqueue.cpp \
+    ../diskcache.cpp \
+    ../renderprofile.cpp \
+    ../tracer.cpp
+
+HEADERS += \
+    ../documentpool.h \
+    ../pagecache.h \
+    ../renderqueue.h \
+    ../diskcache.h \
+    ../renderprofile.h \
+    ../tracer.h
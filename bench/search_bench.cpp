@@ -0,0 +1,182 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //search_bench.cpp
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <algorithm>
+#include <poppler-qt5.h>
+#include "textindex.h"
+#include "textmatcher.h"
+
+// Сравнение путей поиска по документу в одном потоке, теми же функциями,
+// что и в панели поиска: Poppler Page::search, разбор текста страницы
+// с TextMatcher и поиск по готовому TextIndex. Результат — JSON.
+
+static QStringList collectFiles(const QStringList &inputs) {
+    QStringList files;
+    for (const QString &input : inputs) {
+        QFileInfo info(input);
+        if (info.isDir()) {
+            QDirIterator it(input, QStringList() << "*.pdf" << "*.PDF", QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) files.append(it.next());
+        } else if (info.isFile()) {
+            files.append(info.absoluteFilePath());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+struct OpenDocument {
+    QString path;
+    Poppler::Document *doc = nullptr;
+    QSharedPointer<TextIndex> index;
+    int pages = 0;
+};
+
+static QJsonObject result(const QString &mode, qint64 nsecs, int pages, int hits) {
+    double seconds = nsecs / 1e9;
+    QJsonObject run;
+    run["mode"] = mode;
+    run["seconds"] = seconds;
+    run["pagesPerSec"] = seconds > 0 ? pages / seconds : 0.0;
+    run["hits"] = hits;
+    return run;
+}
+
+// Poppler ищет без учёта регистра; TextMatcher — с теми же настройками
+// по умолчанию, поэтому число совпадений сравнимо.
+static QJsonArray runQuery(const QVector<OpenDocument> &docs, const QString &query, int totalPages) {
+    TextMatcher matcher(query, TextMatcher::Options());
+    QJsonArray runs;
+    QElapsedTimer timer;
+
+    int hits = 0;
+    timer.start();
+    for (const OpenDocument &d : docs) {
+        for (int i = 0; i < d.pages; ++i) {
+            Poppler::Page *page = d.doc->page(i);
+            if (!page) continue;
+            hits += page->search(query, Poppler::Page::IgnoreCase).size();
+            delete page;
+        }
+    }
+    runs.append(result("poppler", timer.nsecsElapsed(), totalPages, hits));
+
+    hits = 0;
+    QString text;
+    QVector<QRectF> boxes;
+    timer.restart();
+    for (const OpenDocument &d : docs) {
+        for (int i = 0; i < d.pages; ++i) {
+            Poppler::Page *page = d.doc->page(i);
+            if (!page) continue;
+            TextIndex::extractText(page, text, boxes);
+            for (const TextMatcher::Match &m : matcher.findAll(text)) {
+                hits += TextIndex::rectsForRange(boxes, m.offset, m.length).size();
+            }
+            delete page;
+        }
+    }
+    runs.append(result("extract+matcher", timer.nsecsElapsed(), totalPages, hits));
+
+    hits = 0;
+    timer.restart();
+    for (const OpenDocument &d : docs) {
+        for (int i = 0; i < d.pages; ++i) hits += d.index->find(i, matcher).size();
+    }
+    runs.append(result("index", timer.nsecsElapsed(), totalPages, hits));
+    return runs;
+}
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("search_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Document search benchmark: Poppler vs TextMatcher");
+    parser.addHelpOption();
+    parser.addPositionalArgument("inputs", "PDF files or directories (searched recursively).");
+    QCommandLineOption queryOption(QStringList() << "q" << "query", "Search query (repeatable).", "text");
+    QCommandLineOption pagesOption("max-pages", "Search at most N pages per file (0 = all).", "n", "0");
+    QCommandLineOption outOption("out", "Write JSON to file instead of stdout.", "file");
+    parser.addOption(queryOption);
+    parser.addOption(pagesOption);
+    parser.addOption(outOption);
+    parser.process(app);
+
+    QStringList files = collectFiles(parser.positionalArguments());
+    QStringList queries = parser.values(queryOption);
+    if (queries.isEmpty()) queries << "the" << QString::fromUtf8("и") << "12";
+    int maxPages = parser.value(pagesOption).toInt();
+    if (files.isEmpty()) parser.showHelp(1);
+
+    QVector<OpenDocument> docs;
+    QJsonArray fileList;
+    int totalPages = 0;
+    QElapsedTimer indexTimer;
+    qint64 indexNsecs = 0;
+    for (const QString &file : files) {
+        OpenDocument d;
+        d.path = file;
+        d.doc = Poppler::Document::load(file);
+        if (!d.doc || d.doc->isLocked()) {
+            delete d.doc;
+            continue;
+        }
+        d.pages = d.doc->numPages();
+        if (maxPages > 0) d.pages = qMin(d.pages, maxPages);
+
+        indexTimer.start();
+        d.index = TextIndex::build(d.doc, nullptr);
+        indexNsecs += indexTimer.nsecsElapsed();
+
+        totalPages += d.pages;
+        docs.append(d);
+
+        QJsonObject entry;
+        entry["path"] = file;
+        entry["pages"] = d.pages;
+        fileList.append(entry);
+    }
+
+    QJsonArray queryRuns;
+    for (const QString &query : queries) {
+        QJsonObject entry;
+        entry["query"] = query;
+        entry["runs"] = runQuery(docs, query, totalPages);
+        queryRuns.append(entry);
+    }
+    for (OpenDocument &d : docs) delete d.doc;
+
+    QJsonObject report;
+    report["files"] = fileList;
+    report["pages"] = totalPages;
+    report["indexBuildSeconds"] = indexNsecs / 1e9;
+    report["queries"] = queryRuns;
+    QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet(outOption)) {
+        QFile out(parser.value(outOption));
+        if (!out.open(QIODevice::WriteOnly)) return 2;
+        out.write(json);
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
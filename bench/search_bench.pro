@@ -0,0 +1,29 @@
+QT       += core gui concurrent
+
+TARGET = search_bench
+TEMPLATE = app
+
+CONFIG += c++11 console link_pkgconfig
+CONFIG -= app_bundle
+PKGCONFIG += poppler-qt5
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    search_bench.cpp \
+    ../textindex.cpp \
+    ../textmatcher.cpp \
+    ../documentpool.cpp \
+    ../diskcache.cpp \
+    ../renderprofile.cpp \
+    ../tracer.cpp
+
+HEADERS += \
+    ../textindex.h \
+    ../textmatcher.h \
+    ../documentpool.h \
+    ../diskcache.h \
+    ../renderprofile.h \
+    ../tracer.h
@@ -0,0 +1,162 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //textmatcher_test.cpp
+#include <QtTest>
+#include "textmatcher.h"
+
+// Проверки TextMatcher. Цель matchertest собирает их дважды — с SSE2
+// и с ORION_NO_SIMD, — поэтому оба сканера сверяются с QString::indexOf
+// на одних и тех же данных.
+
+class TextMatcherTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void literalMatchesIndexOf_data();
+    void literalMatchesIndexOf();
+    void caseFolding_data();
+    void caseFolding();
+    void wholeWords_data();
+    void wholeWords();
+    void diacritics_data();
+    void diacritics();
+
+private:
+    static QVector<int> offsets(const QVector<TextMatcher::Match> &matches);
+};
+
+QVector<int> TextMatcherTest::offsets(const QVector<TextMatcher::Match> &matches) {
+    QVector<int> result;
+    for (const TextMatcher::Match &m : matches) result.append(m.offset);
+    return result;
+}
+
+void TextMatcherTest::literalMatchesIndexOf_data() {
+    QTest::addColumn<int>("cs");
+    QTest::newRow("case sensitive") << int(Qt::CaseSensitive);
+    QTest::newRow("case insensitive") << int(Qt::CaseInsensitive);
+}
+
+// Тексты всех длин до 72 символов: совпадение попадает и в блоки
+// по 8 символов, и в хвост, при любом выравнивании.
+void TextMatcherTest::literalMatchesIndexOf() {
+    QFETCH(int, cs);
+    const QString alphabet = QString::fromUtf8("abAB sσΣςſkKé") + QChar(0x212A);
+    quint32 seed = 12345;
+    auto next = [&seed](int bound) {
+        seed = seed * 1103515245u + 12345u;
+        return int((seed >> 16) % quint32(bound));
+    };
+
+    for (int length = 0; length <= 72; ++length) {
+        for (int round = 0; round < 20; ++round) {
+            QString text;
+            for (int i = 0; i < length; ++i) text.append(alphabet[next(alphabet.size())]);
+
+            QString needle;
+            int needleLength = 1 + next(4);
+            if (length >= needleLength && round % 2 == 0) {
+                needle = text.mid(next(length - needleLength + 1), needleLength);
+                if (round % 4 == 0) needle = needle.toUpper();
+            } else {
+                for (int i = 0; i < needleLength; ++i) needle.append(alphabet[next(alphabet.size())]);
+            }
+
+            for (int from = 0; from <= length; from += 1 + length / 8) {
+                int expected = text.indexOf(needle, from, Qt::CaseSensitivity(cs));
+                int actual = TextMatcher::indexOfLiteral(text, needle, from, Qt::CaseSensitivity(cs));
+                if (actual != expected) {
+                    QFAIL(qPrintable(QString("text \"%1\", needle \"%2\", from %3: %4 != %5")
+                                     .arg(text, needle).arg(from).arg(actual).arg(expected)));
+                }
+            }
+        }
+    }
+}
+
+void TextMatcherTest::caseFolding_data() {
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<QVector<int>>("expected");
+
+    QTest::newRow("ascii") << "Find FIND find" << "find" << QVector<int>{0, 5, 10};
+    QTest::newRow("cyrillic") << QString::fromUtf8("Поиск ПОИСК поиск") << QString::fromUtf8("поиск")
+                              << QVector<int>{0, 6, 12};
+    QTest::newRow("final sigma") << QString::fromUtf8("ΚΑΛΟΣ καλος καλοσ") << QString::fromUtf8("σ")
+                                 << QVector<int>{4, 10, 16};
+    QTest::newRow("sigma anchor") << QString::fromUtf8("ς Σ σ") << QString::fromUtf8("Σ ")
+                                  << QVector<int>{0, 2};
+    QTest::newRow("long s") << QString::fromUtf8("ſtraße Straße") << "st" << QVector<int>{0, 7};
+    QTest::newRow("kelvin") << QString(QChar(0x212A)) + "elvin kelvin" << "kelvin" << QVector<int>{0, 7};
+}
+
+void TextMatcherTest::caseFolding() {
+    QFETCH(QString, text);
+    QFETCH(QString, pattern);
+    QFETCH(QVector<int>, expected);
+    QCOMPARE(offsets(TextMatcher(pattern, TextMatcher::Options()).findAll(text)), expected);
+}
+
+void TextMatcherTest::wholeWords_data() {
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<bool>("regex");
+    QTest::addColumn<QVector<int>>("expected");
+
+    QTest::newRow("inside word") << "cat concat cats cat." << "cat" << false << QVector<int>{0, 16};
+    QTest::newRow("retry after rejected") << "catcat cat" << "cat" << false << QVector<int>{7};
+    QTest::newRow("joiner side") << "AB-12 12" << "-12" << false << QVector<int>{2};
+    QTest::newRow("digits") << "12 123 12" << "12" << false << QVector<int>{0, 7};
+    QTest::newRow("cyrillic") << QString::fromUtf8("дом домик дом") << QString::fromUtf8("дом")
+                              << false << QVector<int>{0, 10};
+    QTest::newRow("regex") << "a1 22 b33" << "\\d+" << true << QVector<int>{3};
+}
+
+void TextMatcherTest::wholeWords() {
+    QFETCH(QString, text);
+    QFETCH(QString, pattern);
+    QFETCH(bool, regex);
+    QFETCH(QVector<int>, expected);
+    TextMatcher::Options options = TextMatcher::WholeWords;
+    if (regex) options |= TextMatcher::RegularExpression;
+    QCOMPARE(offsets(TextMatcher(pattern, options).findAll(text)), expected);
+}
+
+void TextMatcherTest::diacritics_data() {
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<bool>("fold");
+    QTest::addColumn<QVector<int>>("expected");
+
+    QTest::newRow("latin") << QString::fromUtf8("naïve café") << "cafe" << true << QVector<int>{6};
+    QTest::newRow("latin, exact") << QString::fromUtf8("naïve café") << "cafe" << false << QVector<int>{};
+    QTest::newRow("pattern folded") << "naive cafe" << QString::fromUtf8("café") << true << QVector<int>{6};
+    QTest::newRow("yo") << QString::fromUtf8("Ёлка и елка") << QString::fromUtf8("елка") << true
+                        << QVector<int>{0, 7};
+    QTest::newRow("short i folded") << QString::fromUtf8("мой мои") << QString::fromUtf8("мои") << true
+                                    << QVector<int>{0, 4};
+}
+
+// Свёртка заменяет символ один к одному, поэтому смещения совпадений
+// указывают в исходный текст.
+void TextMatcherTest::diacritics() {
+    QFETCH(QString, text);
+    QFETCH(QString, pattern);
+    QFETCH(bool, fold);
+    QFETCH(QVector<int>, expected);
+    TextMatcher::Options options = fold ? TextMatcher::Options(TextMatcher::IgnoreDiacritics) : TextMatcher::Options();
+    QVector<TextMatcher::Match> matches = TextMatcher(pattern, options).findAll(text);
+    QCOMPARE(offsets(matches), expected);
+    for (const TextMatcher::Match &m : matches) QCOMPARE(m.length, pattern.size());
+    QCOMPARE(TextMatcher::foldDiacritics(text).size(), text.size());
+}
+
+QTEST_APPLESS_MAIN(TextMatcherTest)
+
+#include "textmatcher_test.moc"
@@ -0,0 +1,21 @@
+QT       += core testlib
+QT       -= gui
+
+TARGET = textmatcher_test
+TEMPLATE = app
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+# qmake CONFIG+=nosimd: те же проверки для посимвольного сканера
+nosimd: DEFINES += ORION_NO_SIMD
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    textmatcher_test.cpp \
+    ../textmatcher.cpp
+
+HEADERS += \
+    ../textmatcher.h
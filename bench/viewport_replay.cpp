@@ -0,0 +1,272 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //viewport_replay.cpp
+#include <QApplication>
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include "pdfviewport.h"
+#include "tracer.h"
+
+// Воспроизводит сценарий прокрутки/масштаба/переходов в PdfViewPort без окна
+// (платформа offscreen) в реальном времени и замеряет, сколько видимые
+// страницы провели пустыми или в черновом качестве, а также паузы GUI-потока
+// длиннее 16 мс.
+//
+//   REPLAY_PDF=doc.pdf [REPLAY_SCRIPT=scroll.txt] [REPLAY_OUT=result.json]
+//   [REPLAY_SIZE=1000x800] viewport_replay
+//
+// Формат сценария: "<мс от начала> <команда> [аргумент]" в каждой строке,
+// команды: scroll <px>, zoom <множитель>, goto <страница>, pagedown, pageup, end.
+
+struct ReplayEvent {
+    int atMs = 0;
+    QString command;
+    double arg = 0.0;
+};
+
+struct PageTimes {
+    double blankMs = 0.0;
+    double draftMs = 0.0;
+    double visibleMs = 0.0;
+};
+
+class ViewportReplay : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void replay();
+    void cleanupTestCase();
+
+private:
+    QList<ReplayEvent> loadScript(const QString &path) const;
+    QList<ReplayEvent> syntheticScript(int pages) const;
+    void apply(const ReplayEvent &event);
+    void sample();
+    QJsonObject report(double durationMs) const;
+
+    QSharedPointer<DocumentPool> m_pool;
+    Poppler::Document *m_doc = nullptr;
+    QMutex m_docMutex;
+    PageCache m_cache;
+    PdfViewPort *m_view = nullptr;
+
+    QElapsedTimer m_clock;
+    double m_lastSampleMs = 0.0;
+    QMap<int, PdfViewPort::PageState> m_lastStates;
+    QHash<int, PageTimes> m_pageTimes;
+    int m_stalls = 0;
+    double m_stallMs = 0.0;
+    double m_maxGapMs = 0.0;
+};
+
+void ViewportReplay::initTestCase() {
+    QString path = qEnvironmentVariable("REPLAY_PDF");
+    if (path.isEmpty()) QSKIP("REPLAY_PDF is not set");
+
+    m_pool = QSharedPointer<DocumentPool>::create(path);
+    m_doc = m_pool->load();
+    QVERIFY2(m_doc && !m_doc->isLocked(), qPrintable("Cannot open " + path));
+
+    QSize size(1000, 800);
+    QStringList dims = qEnvironmentVariable("REPLAY_SIZE").split('x');
+    if (dims.size() == 2 && dims[0].toInt() > 0 && dims[1].toInt() > 0) {
+        size = QSize(dims[0].toInt(), dims[1].toInt());
+    }
+
+    m_view = new PdfViewPort();
+    m_view->resize(size);
+    m_view->setPageCache(&m_cache);
+    m_view->setDocumentPool(m_pool);
+    m_view->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_view));
+}
+
+void ViewportReplay::replay() {
+    QString scriptPath = qEnvironmentVariable("REPLAY_SCRIPT");
+    m_view->setDocument(m_doc, &m_docMutex);
+    QList<ReplayEvent> events = scriptPath.isEmpty() ? syntheticScript(m_view->totalPages()) : loadScript(scriptPath);
+    QVERIFY(!events.isEmpty());
+
+    QTimer sampler;
+    sampler.setTimerType(Qt::PreciseTimer);
+    sampler.setInterval(4);
+    connect(&sampler, &QTimer::timeout, this, &ViewportReplay::sample);
+
+    m_clock.start();
+    m_lastSampleMs = 0.0;
+    m_lastStates = m_view->visiblePageStates();
+    sampler.start();
+
+    for (const ReplayEvent &event : events) {
+        qint64 wait = event.atMs - m_clock.elapsed();
+        if (wait > 0) QTest::qWait(int(wait));
+        if (event.command == "end") break;
+        apply(event);
+    }
+    sample();
+    sampler.stop();
+
+    double duration = m_clock.nsecsElapsed() / 1e6;
+    QByteArray json = QJsonDocument(report(duration)).toJson(QJsonDocument::Indented);
+    QString outPath = qEnvironmentVariable("REPLAY_OUT");
+    if (outPath.isEmpty()) {
+        QTextStream(stdout) << json;
+    } else {
+        QFile out(outPath);
+        QVERIFY(out.open(QIODevice::WriteOnly));
+        out.write(json);
+    }
+}
+
+void ViewportReplay::cleanupTestCase() {
+    if (m_view) {
+        m_view->stopAllRenders();
+        delete m_view;
+        m_view = nullptr;
+    }
+    m_pool.reset();
+    delete m_doc;
+    m_doc = nullptr;
+}
+
+QList<ReplayEvent> ViewportReplay::loadScript(const QString &path) const {
+    QList<ReplayEvent> events;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return events;
+    while (!file.atEnd()) {
+        QString line = QString::fromUtf8(file.readLine()).trimmed();
+        if (line.isEmpty() || line.startsWith('#')) continue;
+        QStringList parts = line.split(' ', Qt::SkipEmptyParts);
+        if (parts.size() < 2) continue;
+        ReplayEvent event;
+        event.atMs = parts[0].toInt();
+        event.command = parts[1].toLower();
+        event.arg = parts.value(2).toDouble();
+        events.append(event);
+    }
+    std::stable_sort(events.begin(), events.end(), [](const ReplayEvent &a, const ReplayEvent &b) {
+        return a.atMs < b.atMs;
+    });
+    return events;
+}
+
+// Синтетический сценарий: 8 с ровной прокрутки со скоростью чтения,
+// серия PageDown, масштаб туда и обратно, переходы по документу.
+QList<ReplayEvent> ViewportReplay::syntheticScript(int pages) const {
+    QList<ReplayEvent> events;
+    auto add = [&events](int at, const QString &command, double arg) {
+        ReplayEvent event;
+        event.atMs = at;
+        event.command = command;
+        event.arg = arg;
+        events.append(event);
+    };
+
+    for (int t = 500; t < 8500; t += 16) add(t, "scroll", 12);
+    for (int i = 0; i < 5; ++i) add(8500 + i * 400, "pagedown", 0);
+    add(10700, "zoom", 1.5);
+    add(12000, "zoom", 1.0 / 1.5);
+    add(13000, "goto", qMax(1, pages / 2));
+    add(14000, "goto", qMax(1, pages - 2));
+    add(15000, "goto", 1);
+    add(16000, "end", 0);
+    return events;
+}
+
+void ViewportReplay::apply(const ReplayEvent &event) {
+    if (event.command == "scroll") {
+        QScrollBar *bar = m_view->verticalScrollBar();
+        bar->setValue(bar->value() + qRound(event.arg));
+    } else if (event.command == "zoom") {
+        m_view->setZoom(m_view->getZoom() * event.arg);
+    } else if (event.command == "goto") {
+        m_view->goToPage(int(event.arg));
+    } else if (event.command == "pagedown") {
+        QTest::keyClick(m_view, Qt::Key_PageDown);
+    } else if (event.command == "pageup") {
+        QTest::keyClick(m_view, Qt::Key_PageUp);
+    }
+}
+
+// Состояние, замеченное в прошлой выборке, считается действовавшим весь
+// интервал до текущей. Интервал длиннее 16 мс означает паузу GUI-потока.
+void ViewportReplay::sample() {
+    double now = m_clock.nsecsElapsed() / 1e6;
+    double gap = now - m_lastSampleMs;
+    if (gap > 16.0) {
+        ++m_stalls;
+        m_stallMs += gap;
+    }
+    m_maxGapMs = qMax(m_maxGapMs, gap);
+
+    for (auto it = m_lastStates.constBegin(); it != m_lastStates.constEnd(); ++it) {
+        PageTimes &times = m_pageTimes[it.key()];
+        times.visibleMs += gap;
+        if (it.value() == PdfViewPort::PageBlank) times.blankMs += gap;
+        else if (it.value() == PdfViewPort::PageDraft) times.draftMs += gap;
+    }
+
+    m_lastSampleMs = now;
+    m_lastStates = m_view->visiblePageStates();
+}
+
+QJsonObject ViewportReplay::report(double durationMs) const {
+    double blank = 0.0, draft = 0.0, visible = 0.0;
+    QList<int> pages = m_pageTimes.keys();
+    std::sort(pages.begin(), pages.end());
+    QJsonArray perPage;
+    for (int page : pages) {
+        const PageTimes &t = m_pageTimes[page];
+        blank += t.blankMs;
+        draft += t.draftMs;
+        visible += t.visibleMs;
+        QJsonObject entry;
+        entry["page"] = page + 1;
+        entry["visibleMs"] = t.visibleMs;
+        entry["blankMs"] = t.blankMs;
+        entry["draftMs"] = t.draftMs;
+        perPage.append(entry);
+    }
+
+    QJsonObject stalls;
+    stalls["count"] = m_stalls;
+    stalls["totalMs"] = m_stallMs;
+    stalls["maxGapMs"] = m_maxGapMs;
+
+    QJsonObject result;
+    result["document"] = m_pool->filePath();
+    result["viewport"] = QString("%1x%2").arg(m_view->width()).arg(m_view->height());
+    result["durationMs"] = durationMs;
+    result["visiblePageMs"] = visible;
+    result["blankMs"] = blank;
+    result["draftMs"] = draft;
+    result["blankRatio"] = visible > 0 ? blank / visible : 0.0;
+    result["draftRatio"] = visible > 0 ? draft / visible : 0.0;
+    result["guiStalls"] = stalls;
+    result["pages"] = perPage;
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    QThreadPool::globalInstance()->setExpiryTimeout(-1);
+    Tracer::start(Tracer::pathFromEnvironment(QStringList()));
+    ViewportReplay replay;
+    int result = QTest::qExec(&replay, argc, argv);
+    Tracer::stop();
+    return result;
+}
+
+#include "viewport_replay.moc"
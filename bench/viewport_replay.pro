@@ -0,0 +1,33 @@
+QT       += core gui widgets concurrent testlib
+
+TARGET = viewport_replay
+TEMPLATE = app
+
+CONFIG += c++11 console link_pkgconfig
+CONFIG -= app_bundle
+PKGCONFIG += poppler-qt5
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    viewport_replay.cpp \
+    ../pdfviewport.cpp \
+    ../custom_widgets.cpp \
+    ../documentpool.cpp \
+    ../pagecache.cpp \
+    ../renderqueue.cpp \
+    ../diskcache.cpp \
+    ../renderprofile.cpp \
+    ../tracer.cpp
+
+HEADERS += \
+    ../pdfviewport.h \
+    ../custom_widgets.h \
+    ../documentpool.h \
+    ../pagecache.h \
+    ../renderqueue.h \
+    ../diskcache.h \
+    ../renderprofile.h \
+    ../tracer.h
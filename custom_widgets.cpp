@@ -9,39 +9,135 @@
  //custom_widgets.cpp
 #include "custom_widgets.h"
 
-PageWidget::PageWidget(QWidget *parent) : QWidget(parent) {
+PageWidget::PageWidget(PageCache *cache, QWidget *parent) : QWidget(parent), m_cache(cache) {
     setAttribute(Qt::WA_OpaquePaintEvent);
 }
 
-void PageWidget::setPixmap(const QPixmap &pix) {
+void PageWidget::setImage(const PageCacheKey &key) {
     m_loading = false;
-    m_currentPixmap = pix;
+    m_imageKey = key;
     update();
 }
 
+bool PageWidget::hasImage() const {
+    return m_cache && m_imageKey.isValid() && m_cache->contains(m_imageKey);
+}
+
+bool PageWidget::hasTile(int tileIndex) const {
+    auto it = m_tiles.constFind(tileIndex);
+    return it != m_tiles.constEnd() && m_cache && m_cache->contains(it->key);
+}
+
 void PageWidget::setLoading() {
     m_loading = true;
 }
 
 void PageWidget::paintEvent(QPaintEvent *) {
     QPainter painter(this);
-    
-    if (!m_currentPixmap.isNull()) {
+    QPixmap pix;
+    if (m_cache && m_imageKey.isValid()) {
+        pix = m_cache->pixmap(m_imageKey);
+    }
+
+    // Рабочий поток отдаёт непрозрачную картинку размера виджета в пикселях
+    // устройства, её достаточно скопировать без масштабирования. Расхождение
+    // в пиксель от округления тоже копируется как есть, недостающая полоса
+    // остаётся белой.
+    QSize deviceSize = (QSizeF(size()) * pix.devicePixelRatio()).toSize();
+    bool exact = !pix.isNull() && qAbs(pix.width() - deviceSize.width()) <= 1
+        && qAbs(pix.height() - deviceSize.height()) <= 1;
+    if (!exact || pix.hasAlphaChannel() || pix.width() < deviceSize.width() || pix.height() < deviceSize.height()) {
+        painter.fillRect(rect(), Qt::white);
+    }
+
+    if (exact) {
+        painter.drawPixmap(0, 0, pix);
+    } else if (!pix.isNull()) {
         painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        painter.drawPixmap(rect(), pix);
     }
 
-    painter.fillRect(rect(), Qt::white);
+    if (m_cache && !m_tiles.isEmpty() && !m_tileImageSize.isEmpty()) {
+        double sx = double(width()) / m_tileImageSize.width();
+        double sy = double(height()) / m_tileImageSize.height();
+        double dpr = devicePixelRatioF();
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, qAbs(sx * dpr - 1.0) > 0.01 || qAbs(sy * dpr - 1.0) > 0.01);
+        for (const Tile &t : m_tiles) {
+            QPixmap tilePix = m_cache->pixmap(t.key);
+            if (tilePix.isNull()) continue;
+            QRectF target(t.imageRect.x() * sx, t.imageRect.y() * sy,
+                          t.imageRect.width() * sx, t.imageRect.height() * sy);
+            painter.drawPixmap(target, tilePix, QRectF(tilePix.rect()));
+        }
+    }
 
-    if (!m_currentPixmap.isNull()) {
-        painter.drawPixmap(rect(), m_currentPixmap);
+    if (!m_highlights.isEmpty() && !m_pageSize.isEmpty()) {
+        painter.save();
+        painter.setCompositionMode(QPainter::CompositionMode_Multiply);
+        painter.setPen(Qt::NoPen);
+        double sx = width() / m_pageSize.width();
+        double sy = height() / m_pageSize.height();
+        for (const QRectF &r : m_highlights) {
+            bool active = (r == m_activeHighlight);
+            painter.setBrush(active ? QColor(255, 140, 0) : QColor(255, 235, 60));
+            painter.drawRect(QRectF(r.x() * sx, r.y() * sy, r.width() * sx, r.height() * sy).adjusted(-1, -1, 1, 1));
+        }
+        painter.restore();
     }
 
     painter.setPen(QColor(200, 200, 200));
     painter.drawRect(0, 0, width() - 1, height() - 1);
 }
 
-void PageWidget::clearPixmap() {
-    m_currentPixmap = QPixmap();
+void PageWidget::clearImage() {
+    m_imageKey = PageCacheKey();
+    m_tiles.clear();
     m_loading = false;
     update();
+}
+
+void PageWidget::setTileLayout(const QSize &imageSize) {
+    if (m_tileImageSize == imageSize) return;
+    m_tileImageSize = imageSize;
+    m_tiles.clear();
+    update();
+}
+
+void PageWidget::setTile(int tileIndex, const QRect &imageRect, const PageCacheKey &key) {
+    m_tiles.insert(tileIndex, Tile{imageRect, key});
+    update();
+}
+
+void PageWidget::dropTilesOutside(const QRect &imageRect) {
+    bool changed = false;
+    for (auto it = m_tiles.begin(); it != m_tiles.end(); ) {
+        if (!it->imageRect.intersects(imageRect)) {
+            it = m_tiles.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+    if (changed) update();
+}
+
+void PageWidget::clearTiles() {
+    if (m_tiles.isEmpty() && m_tileImageSize.isEmpty()) return;
+    m_tiles.clear();
+    m_tileImageSize = QSize();
+    update();
+}
+
+void PageWidget::setHighlights(const QSizeF &pageSize, const QList<QRectF> &rects, const QRectF &active) {
+    m_pageSize = pageSize;
+    m_highlights = rects;
+    m_activeHighlight = active;
+    update();
+}
+
+void PageWidget::clearHighlights() {
+    if (m_highlights.isEmpty()) return;
+    m_highlights.clear();
+    m_activeHighlight = QRectF();
+    update();
 }
\ No newline at end of file
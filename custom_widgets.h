@@ -16,6 +16,8 @@
 #include <QPixmap>
 #include <QPainter>
 #include <QWheelEvent>
+#include <QHash>
+#include "pagecache.h"
 
 class InvertedSpinBox : public QSpinBox {
 protected:
@@ -29,19 +31,42 @@ protected:
 class PageWidget : public QWidget {
     Q_OBJECT
 public:
-    explicit PageWidget(QWidget *parent = nullptr);
-    void setPixmap(const QPixmap &pix);
+    explicit PageWidget(PageCache *cache, QWidget *parent = nullptr);
+    void setImage(const PageCacheKey &key);
     void setLoading();
-    void clearPixmap();
+    void clearImage();
     bool isLoading() const { return m_loading; }
-    bool hasImage() const { return !m_currentPixmap.isNull(); }
+    bool hasImage() const;
+    PageCacheKey imageKey() const { return m_imageKey; }
+
+    void setTileLayout(const QSize &imageSize);
+    QSize tileImageSize() const { return m_tileImageSize; }
+    void setTile(int tileIndex, const QRect &imageRect, const PageCacheKey &key);
+    bool hasTile(int tileIndex) const;
+    bool hasTiles() const { return !m_tiles.isEmpty(); }
+    void dropTilesOutside(const QRect &imageRect);
+    void clearTiles();
+
+    void setHighlights(const QSizeF &pageSize, const QList<QRectF> &rects, const QRectF &active);
+    void clearHighlights();
 
 protected:
     void paintEvent(QPaintEvent *event) override;
 
 private:
+    struct Tile {
+        QRect imageRect;
+        PageCacheKey key;
+    };
+
+    PageCache *m_cache;
     bool m_loading = false;
-    QPixmap m_currentPixmap;
+    PageCacheKey m_imageKey;
+    QSize m_tileImageSize;
+    QHash<int, Tile> m_tiles;
+    QSizeF m_pageSize;
+    QList<QRectF> m_highlights;
+    QRectF m_activeHighlight;
 };
 
 #endif // CUSTOM_WIDGETS_H
\ No newline at end of file
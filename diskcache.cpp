@@ -0,0 +1,227 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //diskcache.cpp
+#include "diskcache.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <algorithm>
+#include <cstring>
+
+static const quint32 ENTRY_MAGIC = 0x4F525043; // "ORPC"
+static const quint16 ENTRY_VERSION = 2;
+
+DiskCache::DiskCache() {
+    QString base = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (base.isEmpty()) base = QDir::tempPath();
+    m_dir = base + "/OrionCorp/PDFReader/pages";
+}
+
+void DiskCache::setEnabled(bool enabled) {
+    QMutexLocker locker(&m_mutex);
+    m_enabled = enabled;
+}
+
+bool DiskCache::isEnabled() const {
+    QMutexLocker locker(&m_mutex);
+    return m_enabled;
+}
+
+void DiskCache::setBudget(qint64 bytes) {
+    QStringList victims;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_budget = bytes;
+        if (m_scanned && m_usedBytes > m_budget) victims = trimLocked();
+    }
+    removeFiles(victims);
+}
+
+void DiskCache::setDirectory(const QString &dir) {
+    QMutexLocker locker(&m_mutex);
+    m_dir = dir;
+    m_scanned = false;
+    m_entries.clear();
+    m_lru.clear();
+    m_usedBytes = 0;
+}
+
+QString DiskCache::directory() const {
+    QMutexLocker locker(&m_mutex);
+    return m_dir;
+}
+
+QByteArray DiskCache::fileIdentity(const QString &path) {
+    QFileInfo info(path);
+    QByteArray id = info.canonicalFilePath().toUtf8();
+    if (id.isEmpty()) id = info.absoluteFilePath().toUtf8();
+    id += '|' + QByteArray::number(info.size());
+    id += '|' + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+    return id;
+}
+
+QString DiskCache::keyFor(const QByteArray &identity, const QByteArray &params) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(identity);
+    hash.addData("#", 1);
+    hash.addData(params);
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString DiskCache::entryPath(const QString &key) const {
+    return m_dir + "/" + key.left(2) + "/" + key + ".page";
+}
+
+// Повреждённая или несовместимая запись удаляется сразу, чтобы не
+// разбирать её при каждом обращении.
+QImage DiskCache::load(const QString &key) {
+    QString path;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_enabled || key.isEmpty()) return QImage();
+        if (!m_scanned) scanLocked();
+        if (!m_entries.contains(key)) return QImage();
+        path = entryPath(key);
+    }
+
+    QImage image;
+    bool valid = false;
+    QFile file(path);
+    if (file.open(QIODevice::ReadWrite)) {
+        QDataStream in(&file);
+        quint32 magic = 0;
+        quint16 version = 0;
+        qint32 width = 0, height = 0, format = 0, bytesPerLine = 0;
+        QByteArray packed;
+        in >> magic >> version >> width >> height >> format >> bytesPerLine >> packed;
+        if (in.status() == QDataStream::Ok && magic == ENTRY_MAGIC && version == ENTRY_VERSION
+                && width > 0 && height > 0 && format > QImage::Format_Invalid && format < QImage::NImageFormats) {
+            QByteArray raw = qUncompress(packed);
+            image = QImage(width, height, QImage::Format(format));
+            if (!image.isNull() && image.bytesPerLine() == bytesPerLine && raw.size() == qint64(bytesPerLine) * height) {
+                memcpy(image.bits(), raw.constData(), size_t(raw.size()));
+                file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+                valid = true;
+            }
+        }
+        file.close();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (!valid) {
+        forgetLocked(key);
+        QFile::remove(path);
+        return QImage();
+    }
+    if (m_entries.contains(key)) touchLocked(key, m_entries.value(key).size);
+    return image;
+}
+
+void DiskCache::store(const QString &key, const QImage &image) {
+    if (image.isNull() || key.isEmpty()) return;
+    QString path;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_enabled) return;
+        path = entryPath(key);
+    }
+
+    QByteArray raw(reinterpret_cast<const char*>(image.constBits()), int(image.sizeInBytes()));
+    QByteArray packed = qCompress(raw, 1);
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return;
+    QDataStream out(&file);
+    out << ENTRY_MAGIC << ENTRY_VERSION << qint32(image.width()) << qint32(image.height())
+        << qint32(image.format()) << qint32(image.bytesPerLine()) << packed;
+    qint64 size = file.size();
+    if (out.status() != QDataStream::Ok || !file.commit()) return;
+
+    QStringList victims;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_scanned) scanLocked();
+        touchLocked(key, size);
+        if (m_usedBytes > m_budget) victims = trimLocked();
+    }
+    removeFiles(victims);
+}
+
+void DiskCache::clear() {
+    QMutexLocker locker(&m_mutex);
+    QDir(m_dir).removeRecursively();
+    m_entries.clear();
+    m_lru.clear();
+    m_usedBytes = 0;
+    m_scanned = true;
+}
+
+// Единственный обход каталога: записи получают порядок по mtime,
+// дальше он ведётся в памяти.
+void DiskCache::scanLocked() {
+    m_entries.clear();
+    m_lru.clear();
+    m_usedBytes = 0;
+
+    QFileInfoList found;
+    const QStringList shards = QDir(m_dir).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &shard : shards) {
+        found += QDir(m_dir + "/" + shard).entryInfoList(QStringList() << "*.page", QDir::Files);
+    }
+    std::sort(found.begin(), found.end(), [](const QFileInfo &a, const QFileInfo &b) {
+        return a.lastModified() < b.lastModified();
+    });
+    for (const QFileInfo &info : found) touchLocked(info.completeBaseName(), info.size());
+    m_scanned = true;
+}
+
+void DiskCache::touchLocked(const QString &key, qint64 size) {
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        m_lru.remove(it->tick);
+        m_usedBytes -= it->size;
+    } else {
+        it = m_entries.insert(key, Entry());
+    }
+    it->size = size;
+    it->tick = ++m_tick;
+    m_lru.insert(it->tick, key);
+    m_usedBytes += size;
+}
+
+void DiskCache::forgetLocked(const QString &key) {
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) return;
+    m_lru.remove(it->tick);
+    m_usedBytes -= it->size;
+    m_entries.erase(it);
+}
+
+// Самые давно использованные записи выбрасываются из индекса, пока объём
+// не опустится до 90% лимита; сами файлы удаляются уже без блокировки.
+QStringList DiskCache::trimLocked() {
+    QStringList victims;
+    qint64 target = m_budget / 10 * 9;
+    while (m_usedBytes > target && !m_lru.isEmpty()) {
+        QString key = m_lru.first();
+        victims.append(entryPath(key));
+        forgetLocked(key);
+    }
+    return victims;
+}
+
+void DiskCache::removeFiles(const QStringList &paths) {
+    for (const QString &path : paths) QFile::remove(path);
+}
@@ -0,0 +1,72 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //diskcache.h
+#ifndef DISKCACHE_H
+#define DISKCACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QImage>
+#include <QMutex>
+#include <QHash>
+#include <QMap>
+#include <QStringList>
+
+// Дисковый кэш отрисованных страниц. Файлы именуются хэшем от идентичности
+// PDF (путь, размер, mtime) и параметров рендера. При чтении mtime записи
+// обновляется, при превышении лимита удаляются самые старые записи.
+// Размеры и порядок использования записей хранятся в памяти: каталог
+// сканируется один раз, при первом обращении.
+// Методы потокобезопасны и вызываются из рабочих потоков рендера.
+class DiskCache {
+public:
+    static const qint64 DefaultBudget = 1024ll * 1024 * 1024;
+
+    DiskCache();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    void setBudget(qint64 bytes);
+    void setDirectory(const QString &dir);
+    QString directory() const;
+
+    static QByteArray fileIdentity(const QString &path);
+    static QString keyFor(const QByteArray &identity, const QByteArray &params);
+
+    QImage load(const QString &key);
+    void store(const QString &key, const QImage &image);
+    void clear();
+
+private:
+    Q_DISABLE_COPY(DiskCache)
+
+    struct Entry {
+        qint64 size = 0;
+        quint64 tick = 0;
+    };
+
+    QString entryPath(const QString &key) const;
+    void scanLocked();
+    void touchLocked(const QString &key, qint64 size);
+    void forgetLocked(const QString &key);
+    QStringList trimLocked();
+    static void removeFiles(const QStringList &paths);
+
+    mutable QMutex m_mutex;
+    QString m_dir;
+    bool m_enabled = false;
+    qint64 m_budget = DefaultBudget;
+    qint64 m_usedBytes = 0;
+    bool m_scanned = false;
+    QHash<QString, Entry> m_entries;
+    QMap<quint64, QString> m_lru;
+    quint64 m_tick = 0;
+};
+
+#endif // DISKCACHE_H
@@ -0,0 +1,87 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //documentpool.cpp
+#include "documentpool.h"
+#include "diskcache.h"
+
+DocumentPool::DocumentPool(const QString &path) : m_path(path) {
+    m_identity = DiskCache::fileIdentity(path);
+    for (int i = 0; i < ProfileCount; ++i) {
+        m_profiles[i] = RenderProfile::defaultFor(RenderProfileId(i));
+    }
+}
+
+DocumentPool::~DocumentPool() {
+    clear();
+}
+
+// Профиль применяется к документу потока только при смене профиля,
+// поэтому чередование черновых и HD-задач почти ничего не стоит.
+Poppler::Document *DocumentPool::acquire(RenderProfileId profile) {
+    QThread *thread = QThread::currentThread();
+    Handle handle;
+    RenderProfile wanted;
+    int serial = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        handle = m_documents.value(thread);
+        wanted = m_profiles[profile];
+        serial = m_profileSerial;
+    }
+
+    if (!handle.doc) {
+        handle.doc = load();
+        if (!handle.doc) return nullptr;
+        if (handle.doc->isLocked()) {
+            delete handle.doc;
+            return nullptr;
+        }
+    }
+
+    if (handle.profile != profile || handle.serial != serial) {
+        wanted.applyTo(handle.doc);
+        handle.profile = profile;
+        handle.serial = serial;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_documents.insert(thread, handle);
+    return handle.doc;
+}
+
+void DocumentPool::setProfile(RenderProfileId id, const RenderProfile &profile) {
+    QMutexLocker locker(&m_mutex);
+    if (m_profiles[id] == profile) return;
+    m_profiles[id] = profile;
+    ++m_profileSerial;
+}
+
+RenderProfile DocumentPool::profile(RenderProfileId id) const {
+    QMutexLocker locker(&m_mutex);
+    return m_profiles[id];
+}
+
+int DocumentPool::profileSerial() const {
+    QMutexLocker locker(&m_mutex);
+    return m_profileSerial;
+}
+
+// Документ открывается по пути: Poppler читает файл сам, и страницы файла
+// делит между документами кэш ОС. loadFromData здесь не подходит —
+// poppler-qt5 отсоединяет переданный QByteArray и держит полную копию PDF
+// в куче на каждый документ.
+Poppler::Document *DocumentPool::load() const {
+    return Poppler::Document::load(m_path);
+}
+
+void DocumentPool::clear() {
+    QMutexLocker locker(&m_mutex);
+    for (const Handle &handle : m_documents) delete handle.doc;
+    m_documents.clear();
+}
@@ -0,0 +1,61 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //documentpool.h
+#ifndef DOCUMENTPOOL_H
+#define DOCUMENTPOOL_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <poppler-qt5.h>
+#include "renderprofile.h"
+
+// Один Poppler::Document на рабочий поток для одного файла.
+// Документ загружается при первом обращении из потока и используется
+// только этим потоком, поэтому рендер не требует общей блокировки.
+// Документы потоков удаляются только вместе с пулом: задачи держат пул
+// через QSharedPointer, поэтому документ не исчезает посреди работы.
+class DocumentPool {
+public:
+    explicit DocumentPool(const QString &path);
+    ~DocumentPool();
+
+    Poppler::Document *acquire(RenderProfileId profile = ProfileHD);
+    Poppler::Document *load() const;
+
+    void setProfile(RenderProfileId id, const RenderProfile &profile);
+    RenderProfile profile(RenderProfileId id) const;
+    int profileSerial() const;
+
+    QString filePath() const { return m_path; }
+    QByteArray fileIdentity() const { return m_identity; }
+
+private:
+    Q_DISABLE_COPY(DocumentPool)
+
+    void clear();
+
+    QString m_path;
+    QByteArray m_identity;
+
+    struct Handle {
+        Poppler::Document *doc = nullptr;
+        int profile = -1;
+        int serial = -1;
+    };
+
+    mutable QMutex m_mutex;
+    QHash<QThread*, Handle> m_documents;
+    RenderProfile m_profiles[ProfileCount];
+    int m_profileSerial = 0;
+};
+
+#endif // DOCUMENTPOOL_H
@@ -0,0 +1,746 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //libraryindex.cpp
+#include "libraryindex.h"
+#include "tracer.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QLockFile>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QThread>
+#include <QThreadPool>
+#include <QtEndian>
+#include <QVector>
+#include <QtConcurrent>
+#include <poppler-qt5.h>
+#include <algorithm>
+
+static const quint32 TABLE_MAGIC = 0x4F524C54; // "ORLT"
+static const quint32 SHARD_MAGIC = 0x4F524C53; // "ORLS"
+static const quint16 INDEX_VERSION = 2;
+static const QDataStream::Version STREAM_VERSION = QDataStream::Qt_5_12;
+// Минимальные размеры записей в файле: путь, размер, mtime, состояние
+// документа; терм и постинги в блоке.
+static const qint64 MIN_DOC_BYTES = 4 + 8 + 8 + 1;
+// Запись словаря блока: хэш терма и смещение записи терма в блоке.
+static const quint32 DICT_RECORD_BYTES = 8 + 4;
+static const int MAX_SHARD_BLOCKS = 16;
+static const int SHARD_COUNT = 64;
+static const int MAX_PENDING_POSTINGS = 1000000;
+static const int MIN_TERM = 2;
+static const int MAX_TERM = 64;
+static const int LOCK_RETRY_MS = 100;
+static const int LOCK_TIMEOUT_MS = 10000;
+
+// Индексатор работает часами, поэтому у него свой поток, а не поток
+// глобального пула, нужного рендеру и миниатюрам.
+struct IndexerThreadPool : QThreadPool {
+    IndexerThreadPool() { setMaxThreadCount(1); }
+};
+Q_GLOBAL_STATIC(IndexerThreadPool, indexerThreadPool)
+
+enum DocState {
+    DocPending,
+    DocIndexed,
+    DocDead,
+    DocPurged
+};
+
+struct DocEntry {
+    QString path;
+    qint64 size = 0;
+    qint64 mtime = 0;
+    quint8 state = DocPending;
+};
+
+// Постинг — (документ << 32 | страница); в блоке шарда постинги терма
+// отсортированы и записаны разностями в varint.
+typedef QHash<QString, QVector<quint64>> PendingPostings;
+
+static void appendVarint(QByteArray &out, quint64 v) {
+    while (v >= 0x80) {
+        out.append(char(v | 0x80));
+        v >>= 7;
+    }
+    out.append(char(v));
+}
+
+static QByteArray encodePostings(const QVector<quint64> &postings) {
+    QByteArray out;
+    out.reserve(postings.size() * 2);
+    quint64 prev = 0;
+    for (quint64 p : postings) {
+        appendVarint(out, p - prev);
+        prev = p;
+    }
+    return out;
+}
+
+static QVector<quint64> decodePostings(const QByteArray &data) {
+    QVector<quint64> postings;
+    const uchar *p = reinterpret_cast<const uchar*>(data.constData());
+    const uchar *end = p + data.size();
+    quint64 value = 0;
+    while (p < end) {
+        quint64 delta = 0;
+        int shift = 0;
+        while (p < end && shift < 64) {
+            uchar b = *p++;
+            delta |= quint64(b & 0x7F) << shift;
+            if (!(b & 0x80)) break;
+            shift += 7;
+        }
+        value += delta;
+        postings.append(value);
+    }
+    return postings;
+}
+
+// FNV-1a: номер шарда не должен зависеть от версии Qt и процессора.
+static int shardOf(const QString &term) {
+    quint32 h = 2166136261u;
+    for (QChar c : term) {
+        h = (h ^ c.unicode()) * 16777619u;
+    }
+    return int(h % SHARD_COUNT);
+}
+
+// Ключ словаря блока; совпадение хэша проверяется сравнением терма.
+static quint64 termHash(const QString &term) {
+    quint64 h = 14695981039346656037ull;
+    for (QChar c : term) {
+        h = (h ^ c.unicode()) * 1099511628211ull;
+    }
+    return h;
+}
+
+// Блок шарда: число термов, словарь (хэш терма, смещение записи),
+// отсортированный по хэшу, и записи (терм, постинги). Запрос находит терм
+// двоичным поиском по словарю и читает только его записи, поэтому его
+// стоимость зависит от постингов терма, а не от размера шарда.
+static QByteArray encodeBlock(const QStringList &terms, const PendingPostings &postings) {
+    QVector<QPair<quint64, quint32>> dict;
+    dict.reserve(terms.size());
+    QByteArray body;
+    QDataStream entries(&body, QIODevice::WriteOnly);
+    entries.setVersion(STREAM_VERSION);
+    for (const QString &term : terms) {
+        dict.append(qMakePair(termHash(term), quint32(entries.device()->pos())));
+        entries << term << encodePostings(postings.value(term));
+    }
+    std::sort(dict.begin(), dict.end());
+
+    quint32 header = 4 + quint32(dict.size()) * DICT_RECORD_BYTES;
+    QByteArray block(int(header), Qt::Uninitialized);
+    uchar *p = reinterpret_cast<uchar*>(block.data());
+    qToLittleEndian<quint32>(quint32(dict.size()), p);
+    p += 4;
+    for (const QPair<quint64, quint32> &record : dict) {
+        qToLittleEndian<quint64>(record.first, p);
+        qToLittleEndian<quint32>(header + record.second, p + 8);
+        p += DICT_RECORD_BYTES;
+    }
+    return block + body;
+}
+
+// Файл шарда, отображённый в память. Заголовок и длины блоков записаны
+// QDataStream (big-endian); словари и записи читаются на месте.
+class ShardReader {
+public:
+    explicit ShardReader(const QString &path);
+
+    int blockCount() const { return m_blocks.size(); }
+    QVector<quint64> find(const QString &term) const;
+    template <typename F>
+    void forEachEntry(F callback) const;
+
+private:
+    Q_DISABLE_COPY(ShardReader)
+
+    struct Block {
+        const uchar *data;
+        quint32 size;
+        quint32 count;
+    };
+
+    static bool readEntry(const Block &block, quint32 record, QString &term, QByteArray &postings);
+
+    QFile m_file;
+    QByteArray m_buffer;
+    QVector<Block> m_blocks;
+};
+
+ShardReader::ShardReader(const QString &path) : m_file(path) {
+    if (!m_file.open(QIODevice::ReadOnly)) return;
+    qint64 size = m_file.size();
+    const uchar *data = size > 0 ? m_file.map(0, size) : nullptr;
+    if (!data) {
+        m_buffer = m_file.readAll();
+        data = reinterpret_cast<const uchar*>(m_buffer.constData());
+        size = m_buffer.size();
+    }
+    if (size < 6 || qFromBigEndian<quint32>(data) != SHARD_MAGIC || qFromBigEndian<quint16>(data + 4) != INDEX_VERSION) {
+        return;
+    }
+
+    qint64 pos = 6;
+    while (pos + 4 <= size) {
+        quint32 length = qFromBigEndian<quint32>(data + pos);
+        if (length < 4 || length > size - pos - 4) break; // недописанный хвост
+        Block block;
+        block.data = data + pos + 4;
+        block.size = length;
+        block.count = qFromLittleEndian<quint32>(block.data);
+        if (block.count > (length - 4) / DICT_RECORD_BYTES) break;
+        m_blocks.append(block);
+        pos += 4 + qint64(length);
+    }
+}
+
+bool ShardReader::readEntry(const Block &block, quint32 record, QString &term, QByteArray &postings) {
+    quint32 offset = qFromLittleEndian<quint32>(block.data + 4 + record * DICT_RECORD_BYTES + 8);
+    if (offset >= block.size) return false;
+    QByteArray raw = QByteArray::fromRawData(reinterpret_cast<const char*>(block.data + offset),
+                                             int(block.size - offset));
+    QDataStream in(raw);
+    in.setVersion(STREAM_VERSION);
+    in >> term >> postings;
+    return in.status() == QDataStream::Ok;
+}
+
+QVector<quint64> ShardReader::find(const QString &term) const {
+    QVector<quint64> postings;
+    quint64 hash = termHash(term);
+    for (const Block &block : m_blocks) {
+        const uchar *dict = block.data + 4;
+        quint32 lo = 0;
+        quint32 hi = block.count;
+        while (lo < hi) {
+            quint32 mid = lo + (hi - lo) / 2;
+            if (qFromLittleEndian<quint64>(dict + mid * DICT_RECORD_BYTES) < hash) lo = mid + 1;
+            else hi = mid;
+        }
+        for (; lo < block.count && qFromLittleEndian<quint64>(dict + lo * DICT_RECORD_BYTES) == hash; ++lo) {
+            QString stored;
+            QByteArray data;
+            if (readEntry(block, lo, stored, data) && stored == term) postings += decodePostings(data);
+        }
+    }
+    return postings;
+}
+
+template <typename F>
+void ShardReader::forEachEntry(F callback) const {
+    for (const Block &block : m_blocks) {
+        for (quint32 i = 0; i < block.count; ++i) {
+            QString term;
+            QByteArray postings;
+            if (readEntry(block, i, term, postings)) callback(term, postings);
+        }
+    }
+}
+
+struct LibraryIndex::Store {
+    QString root;
+    QString dir;
+    QMutex mutex;
+    QVector<DocEntry> docs;
+    QAtomicInt done;
+    QAtomicInt total;
+
+    QString tablePath() const { return dir + "/docs.dat"; }
+    QString shardPath(int shard) const { return dir + QString("/shard_%1.dat").arg(shard, 2, 10, QLatin1Char('0')); }
+
+    void update(const QAtomicInt *canceled);
+    QList<LibraryHit> query(const QStringList &terms, int maxHits);
+
+private:
+    void loadTable();
+    void saveTable();
+    void repairShard(int shard);
+    bool indexDocument(const QFileInfo &fi, quint32 id, PendingPostings &pending, int &pendingCount,
+                       const QAtomicInt *canceled);
+    void flush(PendingPostings &pending, QVector<int> &pendingDocs);
+    void compact(const QAtomicInt *canceled);
+};
+
+
+// Таблица документов без шардов бесполезна и наоборот: если таблица
+// не читается, шарды удаляются, и индекс строится заново.
+void LibraryIndex::Store::loadTable() {
+    QVector<DocEntry> loaded;
+    bool valid = false;
+
+    QFile file(tablePath());
+    if (file.open(QIODevice::ReadOnly)) {
+        QDataStream in(&file);
+        in.setVersion(STREAM_VERSION);
+        quint32 magic = 0;
+        quint16 version = 0;
+        qint32 count = 0;
+        in >> magic >> version >> count;
+        if (in.status() == QDataStream::Ok && magic == TABLE_MAGIC && version == INDEX_VERSION && count >= 0
+                && count <= (file.size() - file.pos()) / MIN_DOC_BYTES) {
+            loaded.resize(count);
+            for (DocEntry &d : loaded) {
+                in >> d.path >> d.size >> d.mtime >> d.state;
+            }
+            valid = in.status() == QDataStream::Ok;
+        }
+    }
+
+    if (!valid) {
+        loaded.clear();
+        for (int s = 0; s < SHARD_COUNT; ++s) QFile::remove(shardPath(s));
+    }
+
+    QMutexLocker locker(&mutex);
+    docs = loaded;
+}
+
+void LibraryIndex::Store::saveTable() {
+    QVector<DocEntry> snapshot;
+    {
+        QMutexLocker locker(&mutex);
+        snapshot = docs;
+    }
+
+    QSaveFile file(tablePath());
+    if (!file.open(QIODevice::WriteOnly)) return;
+    QDataStream out(&file);
+    out.setVersion(STREAM_VERSION);
+    out << TABLE_MAGIC << INDEX_VERSION << qint32(snapshot.size());
+    for (const DocEntry &d : snapshot) {
+        out << d.path << d.size << d.mtime << d.state;
+    }
+    if (out.status() == QDataStream::Ok) file.commit();
+}
+
+// Обрезает блок, недописанный при аварийном завершении, чтобы следующие
+// блоки дописывались к целому файлу.
+void LibraryIndex::Store::repairShard(int shard) {
+    QFile file(shardPath(shard));
+    if (!file.exists() || !file.open(QIODevice::ReadWrite)) return;
+
+    QDataStream in(&file);
+    in.setVersion(STREAM_VERSION);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != SHARD_MAGIC || version != INDEX_VERSION) {
+        file.resize(0);
+        return;
+    }
+
+    qint64 good = file.pos();
+    while (!in.atEnd()) {
+        quint32 length = 0;
+        in >> length;
+        if (in.status() != QDataStream::Ok || in.skipRawData(int(length)) != int(length)) break;
+        good = file.pos();
+    }
+    if (good < file.size()) file.resize(good);
+}
+
+bool LibraryIndex::Store::indexDocument(const QFileInfo &fi, quint32 id, PendingPostings &pending, int &pendingCount,
+                                        const QAtomicInt *canceled) {
+    // Нечитаемые и зашифрованные файлы считаются проиндексированными без
+    // текста и не перечитываются, пока не изменятся.
+    Poppler::Document *doc = Poppler::Document::load(fi.absoluteFilePath());
+    if (!doc) return true;
+    if (doc->isLocked()) {
+        delete doc;
+        return true;
+    }
+
+    int pages = doc->numPages();
+    for (int i = 0; i < pages; ++i) {
+        if (canceled->load() == 1) {
+            delete doc;
+            return false;
+        }
+        Poppler::Page *page = doc->page(i);
+        if (!page) continue;
+        QString text = page->text(QRectF());
+        delete page;
+
+        quint64 posting = (quint64(id) << 32) | quint32(i);
+        const QStringList terms = LibraryIndex::tokenize(text);
+        for (const QString &term : terms) {
+            pending[term].append(posting);
+        }
+        pendingCount += terms.size();
+    }
+    delete doc;
+    return true;
+}
+
+// Постинги дописываются в конец файлов шардов, существующие блоки
+// не переписываются. Документы помечаются проиндексированными только
+// после записи, поэтому прерванный сброс оставляет их «ожидающими»,
+// и при следующем запуске они считаются мёртвыми.
+void LibraryIndex::Store::flush(PendingPostings &pending, QVector<int> &pendingDocs) {
+    if (!pending.isEmpty()) {
+        QVector<QStringList> termsByShard(SHARD_COUNT);
+        for (auto it = pending.constBegin(); it != pending.constEnd(); ++it) {
+            termsByShard[shardOf(it.key())].append(it.key());
+        }
+
+        for (int s = 0; s < SHARD_COUNT; ++s) {
+            const QStringList &terms = termsByShard[s];
+            if (terms.isEmpty()) continue;
+
+            QByteArray block = encodeBlock(terms, pending);
+
+            QFile file(shardPath(s));
+            if (!file.open(QIODevice::ReadWrite)) continue;
+            file.seek(file.size());
+            QDataStream out(&file);
+            out.setVersion(STREAM_VERSION);
+            if (file.size() == 0) out << SHARD_MAGIC << INDEX_VERSION;
+            out << block;
+        }
+        pending.clear();
+    }
+
+    {
+        QMutexLocker locker(&mutex);
+        for (int id : pendingDocs) docs[id].state = DocIndexed;
+    }
+    pendingDocs.clear();
+    saveTable();
+}
+
+// Мёртвые постинги отфильтровываются при запросе, а когда их становится
+// заметно много, шарды переписываются без них. Шард, в котором накопилось
+// много блоков, тоже переписывается: блоки сливаются в один, и запрос
+// делает один двоичный поиск на шард вместо поиска в каждом блоке.
+void LibraryIndex::Store::compact(const QAtomicInt *canceled) {
+    QVector<bool> alive;
+    int dead = 0;
+    int live = 0;
+    {
+        QMutexLocker locker(&mutex);
+        alive.resize(docs.size());
+        for (int i = 0; i < docs.size(); ++i) {
+            alive[i] = docs[i].state == DocIndexed;
+            if (docs[i].state == DocDead) ++dead;
+            if (alive[i]) ++live;
+        }
+    }
+    bool purge = dead > 0 && (dead >= 1000 || dead * 4 >= live);
+
+    TraceSpan span("library compact", "library");
+    for (int s = 0; s < SHARD_COUNT; ++s) {
+        if (canceled->load() == 1) return;
+
+        PendingPostings merged;
+        {
+            ShardReader reader(shardPath(s));
+            if (reader.blockCount() == 0 || (!purge && reader.blockCount() <= MAX_SHARD_BLOCKS)) continue;
+            reader.forEachEntry([&](const QString &term, const QByteArray &data) {
+                QVector<quint64> &kept = merged[term];
+                for (quint64 p : decodePostings(data)) {
+                    quint32 doc = quint32(p >> 32);
+                    if (int(doc) < alive.size() && alive[doc]) kept.append(p);
+                }
+            });
+        }
+
+        QStringList terms;
+        for (auto it = merged.begin(); it != merged.end(); ++it) {
+            if (it.value().isEmpty()) continue;
+            std::sort(it.value().begin(), it.value().end());
+            terms.append(it.key());
+        }
+
+        QSaveFile out(shardPath(s));
+        if (!out.open(QIODevice::WriteOnly)) continue;
+        QDataStream outStream(&out);
+        outStream.setVersion(STREAM_VERSION);
+        outStream << SHARD_MAGIC << INDEX_VERSION;
+        if (!terms.isEmpty()) outStream << encodeBlock(terms, merged);
+        if (outStream.status() == QDataStream::Ok) out.commit();
+        else out.cancelWriting();
+    }
+    if (!purge) return;
+
+    {
+        QMutexLocker locker(&mutex);
+        for (DocEntry &d : docs) {
+            if (d.state == DocDead) {
+                d.state = DocPurged;
+                d.path.clear();
+            }
+        }
+    }
+    saveTable();
+}
+
+void LibraryIndex::Store::update(const QAtomicInt *canceled) {
+    TraceSpan span("library index", "library");
+    if (span.isActive()) span.setArgs(QJsonObject{{"root", root}});
+    QDir().mkpath(dir);
+    // Индекс может обновлять другой экземпляр программы. Блокировка ждётся
+    // короткими попытками с проверкой отмены, чтобы закрытие не зависало.
+    QLockFile lock(dir + "/lock");
+    for (int waited = 0; !lock.tryLock(0); waited += LOCK_RETRY_MS) {
+        if (canceled->load() == 1 || waited >= LOCK_TIMEOUT_MS) return;
+        QThread::msleep(LOCK_RETRY_MS);
+    }
+    QThread::currentThread()->setPriority(QThread::LowestPriority);
+
+    loadTable();
+    for (int s = 0; s < SHARD_COUNT; ++s) repairShard(s);
+
+    // Тот же набор файлов, что показывает боковая панель: корень
+    // и подпапки первого уровня.
+    QFileInfoList files;
+    QDir mainDir(root);
+    QStringList filters = {"*.pdf", "*.PDF"};
+    files += mainDir.entryInfoList(filters, QDir::Files);
+    for (const QString &sub : mainDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        files += QDir(mainDir.absoluteFilePath(sub)).entryInfoList(filters, QDir::Files);
+    }
+
+    QHash<QString, int> indexed;
+    {
+        QMutexLocker locker(&mutex);
+        for (int i = 0; i < docs.size(); ++i) {
+            if (docs[i].state == DocPending) docs[i].state = DocDead;
+            if (docs[i].state == DocIndexed) indexed.insert(docs[i].path, i);
+        }
+    }
+
+    QFileInfoList changed;
+    QSet<QString> unchanged;
+    for (const QFileInfo &fi : files) {
+        QString path = fi.absoluteFilePath();
+        auto it = indexed.constFind(path);
+        if (it != indexed.constEnd()) {
+            const DocEntry &d = docs.at(it.value());
+            if (d.size == fi.size() && d.mtime == fi.lastModified().toMSecsSinceEpoch()) {
+                unchanged.insert(path);
+                continue;
+            }
+        }
+        changed.append(fi);
+    }
+
+    // Изменённые и удалённые файлы: старые записи становятся мёртвыми.
+    {
+        QMutexLocker locker(&mutex);
+        for (auto it = indexed.constBegin(); it != indexed.constEnd(); ++it) {
+            if (!unchanged.contains(it.key())) docs[it.value()].state = DocDead;
+        }
+    }
+
+    total.store(changed.size());
+    done.store(0);
+
+    PendingPostings pending;
+    QVector<int> pendingDocs;
+    int pendingCount = 0;
+    for (const QFileInfo &fi : changed) {
+        if (canceled->load() == 1) break;
+
+        int id;
+        {
+            QMutexLocker locker(&mutex);
+            id = docs.size();
+            DocEntry entry;
+            entry.path = fi.absoluteFilePath();
+            entry.size = fi.size();
+            entry.mtime = fi.lastModified().toMSecsSinceEpoch();
+            docs.append(entry);
+        }
+
+        if (!indexDocument(fi, quint32(id), pending, pendingCount, canceled)) {
+            QMutexLocker locker(&mutex);
+            docs[id].state = DocDead;
+            break;
+        }
+        pendingDocs.append(id);
+        done.ref();
+
+        if (pendingCount >= MAX_PENDING_POSTINGS) {
+            flush(pending, pendingDocs);
+            pendingCount = 0;
+        }
+    }
+    flush(pending, pendingDocs);
+    compact(canceled);
+    QThread::currentThread()->setPriority(QThread::NormalPriority);
+}
+
+// Термы запроса объединяются по «и» на уровне страницы. Каждый терм
+// ищется по словарям блоков своего шарда.
+QList<LibraryHit> LibraryIndex::Store::query(const QStringList &terms, int maxHits) {
+    QList<LibraryHit> hits;
+    if (terms.isEmpty()) return hits;
+
+    TraceSpan span("library query", "library");
+    QHash<int, QSet<QString>> shards;
+    for (const QString &term : terms) shards[shardOf(term)].insert(term);
+
+    QHash<QString, QSet<quint64>> found;
+    for (auto it = shards.constBegin(); it != shards.constEnd(); ++it) {
+        ShardReader reader(shardPath(it.key()));
+        for (const QString &term : it.value()) {
+            QSet<quint64> &set = found[term];
+            for (quint64 p : reader.find(term)) set.insert(p);
+        }
+    }
+
+    QSet<quint64> pages = found.value(terms.first());
+    for (int i = 1; i < terms.size() && !pages.isEmpty(); ++i) {
+        pages.intersect(found.value(terms[i]));
+    }
+
+    QVector<quint64> sorted;
+    sorted.reserve(pages.size());
+    for (quint64 p : pages) sorted.append(p);
+    std::sort(sorted.begin(), sorted.end());
+
+    {
+        QMutexLocker locker(&mutex);
+        for (quint64 p : sorted) {
+            int doc = int(p >> 32);
+            if (doc >= docs.size() || docs[doc].state != DocIndexed) continue;
+            LibraryHit hit;
+            hit.path = docs[doc].path;
+            hit.page = int(quint32(p));
+            hits.append(hit);
+            if (hits.size() >= maxHits) break;
+        }
+    }
+
+    std::stable_sort(hits.begin(), hits.end(), [](const LibraryHit &a, const LibraryHit &b) {
+        return a.path < b.path;
+    });
+    return hits;
+}
+
+LibraryIndex::LibraryIndex(QObject *parent) : QObject(parent) {
+    m_watcher = new QFutureWatcher<void>(this);
+    m_progressTimer = new QTimer(this);
+    m_progressTimer->setInterval(500);
+
+    connect(m_progressTimer, &QTimer::timeout, this, [this]() {
+        if (m_store) emit progress(m_store->done.load(), m_store->total.load());
+    });
+    connect(m_watcher, &QFutureWatcher<void>::finished, this, [this]() {
+        m_progressTimer->stop();
+        if (!m_store || !m_canceled || m_canceled->load() == 1) return;
+        emit progress(m_store->done.load(), m_store->total.load());
+        emit finished();
+    });
+}
+
+// Задача индексации держит своё хранилище сама и по флагу отмены
+// дописывает накопленное и завершается; ждать её здесь не нужно.
+LibraryIndex::~LibraryIndex() {
+    cancel();
+}
+
+void LibraryIndex::cancel() {
+    if (m_canceled) m_canceled->store(1);
+    m_progressTimer->stop();
+}
+
+void LibraryIndex::setRoot(const QString &root) {
+    cancel();
+    if (root.isEmpty()) {
+        m_store.reset();
+        return;
+    }
+
+    QString base = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (base.isEmpty()) base = QDir::tempPath();
+    QString hash = QString::fromLatin1(QCryptographicHash::hash(QDir(root).absolutePath().toUtf8(),
+                                                               QCryptographicHash::Sha1).toHex());
+
+    QSharedPointer<Store> store = QSharedPointer<Store>::create();
+    store->root = root;
+    store->dir = base + "/OrionCorp/PDFReader/library/" + hash;
+    QSharedPointer<QAtomicInt> canceled = QSharedPointer<QAtomicInt>::create(0);
+    m_store = store;
+    m_canceled = canceled;
+
+    m_watcher->setFuture(QtConcurrent::run(indexerThreadPool(), [store, canceled]() {
+        store->update(canceled.data());
+    }));
+    m_progressTimer->start();
+}
+
+QFuture<QList<LibraryHit>> LibraryIndex::query(const QString &text, int maxHits) const {
+    QSharedPointer<Store> store = m_store;
+    QStringList terms = tokenize(text);
+    return QtConcurrent::run([store, terms, maxHits]() {
+        return store ? store->query(terms, maxHits) : QList<LibraryHit>();
+    });
+}
+
+// Термы — слова из букв и цифр в нижнем регистре. Дефис, точка, слэш
+// и подчёркивание внутри слова сохраняются, чтобы номера деталей вида
+// «AB-12.5» находились целиком; части составного слова — отдельные термы.
+// Термы идут в порядке первого появления в тексте.
+QStringList LibraryIndex::tokenize(const QString &text) {
+    QSet<QString> seen;
+    QStringList terms;
+    auto isJoiner = [](QChar c) {
+        return c == QLatin1Char('-') || c == QLatin1Char('.') || c == QLatin1Char('/') || c == QLatin1Char('_');
+    };
+    auto add = [&seen, &terms](const QString &term) {
+        if (term.size() < MIN_TERM || term.size() > MAX_TERM || seen.contains(term)) return;
+        seen.insert(term);
+        terms.append(term);
+    };
+
+    const int n = text.size();
+    int i = 0;
+    while (i < n) {
+        if (!text[i].isLetterOrNumber()) {
+            ++i;
+            continue;
+        }
+        int start = i;
+        bool compound = false;
+        while (i < n) {
+            if (text[i].isLetterOrNumber()) {
+                ++i;
+            } else if (isJoiner(text[i]) && i + 1 < n && text[i + 1].isLetterOrNumber()) {
+                compound = true;
+                ++i;
+            } else {
+                break;
+            }
+        }
+
+        QString word = text.mid(start, i - start).toLower();
+        add(word);
+        if (compound) {
+            int partStart = 0;
+            for (int k = 0; k <= word.size(); ++k) {
+                if (k == word.size() || isJoiner(word[k])) {
+                    add(word.mid(partStart, k - partStart));
+                    partStart = k + 1;
+                }
+            }
+        }
+    }
+    return terms;
+}
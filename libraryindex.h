@@ -0,0 +1,61 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //libraryindex.h
+#ifndef LIBRARYINDEX_H
+#define LIBRARYINDEX_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QTimer>
+
+struct LibraryHit {
+    QString path;
+    int page = -1;
+};
+
+// Полнотекстовый индекс библиотеки: терм → (документ, страница).
+// Индексатор работает в одном фоновом потоке и обновляет индекс
+// инкрементально: файлы с прежними размером и mtime пропускаются.
+// Постинги копятся в памяти до лимита и дописываются блоками в файлы
+// шардов (терм → шард по хэшу), поэтому память ограничена. У каждого
+// блока свой словарь термов: запрос находит постинги своих термов
+// двоичным поиском, не разбирая остальные записи шарда.
+class LibraryIndex : public QObject {
+    Q_OBJECT
+public:
+    explicit LibraryIndex(QObject *parent = nullptr);
+    ~LibraryIndex();
+
+    void setRoot(const QString &root);
+    void cancel();
+    bool isIndexing() const { return m_watcher->isRunning(); }
+
+    QFuture<QList<LibraryHit>> query(const QString &text, int maxHits = 500) const;
+    static QStringList tokenize(const QString &text);
+
+signals:
+    void progress(int done, int total);
+    void finished();
+
+private:
+    struct Store;
+
+    QSharedPointer<Store> m_store;
+    QSharedPointer<QAtomicInt> m_canceled;
+    QFutureWatcher<void> *m_watcher;
+    QTimer *m_progressTimer;
+};
+
+#endif // LIBRARYINDEX_H
@@ -0,0 +1,119 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //librarysearchview.cpp
+#include "librarysearchview.h"
+#include <QVBoxLayout>
+#include <QFileInfo>
+
+LibrarySearchView::LibrarySearchView(LibraryIndex *index, QWidget *parent)
+    : QWidget(parent), m_index(index) {
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+    layout->setSpacing(4);
+
+    m_field = new QLineEdit();
+    m_field->setPlaceholderText("Поиск по библиотеке...");
+    m_field->setClearButtonEnabled(true);
+
+    m_indexStatus = new QLabel();
+    m_indexStatus->setStyleSheet("color: #666;");
+    m_resultStatus = new QLabel();
+    m_resultStatus->setStyleSheet("font-weight: bold; color: #2980b9;");
+    m_resultStatus->setWordWrap(true);
+
+    m_results = new QTreeWidget();
+    m_results->setHeaderHidden(true);
+    m_results->setColumnCount(1);
+
+    layout->addWidget(m_field);
+    layout->addWidget(m_resultStatus);
+    layout->addWidget(m_results, 1);
+    layout->addWidget(m_indexStatus);
+
+    m_watcher = new QFutureWatcher<QList<LibraryHit>>(this);
+    connect(m_watcher, &QFutureWatcher<QList<LibraryHit>>::finished, this, &LibrarySearchView::onResults);
+    connect(m_field, &QLineEdit::returnPressed, this, &LibrarySearchView::onSearch);
+    connect(m_index, &LibraryIndex::progress, this, &LibrarySearchView::onProgress);
+    connect(m_index, &LibraryIndex::finished, this, &LibrarySearchView::onIndexFinished);
+
+    auto hitOf = [](QTreeWidgetItem *item, QString &path, int &page) {
+        path = item->data(0, Qt::UserRole).toString();
+        page = item->data(0, Qt::UserRole + 1).toInt();
+        return !path.isEmpty();
+    };
+    connect(m_results, &QTreeWidget::itemClicked, this, [this, hitOf](QTreeWidgetItem *item) {
+        QString path;
+        int page;
+        if (hitOf(item, path, page)) emit hitSelected(path, page, m_query);
+    });
+    connect(m_results, &QTreeWidget::itemDoubleClicked, this, [this, hitOf](QTreeWidgetItem *item) {
+        QString path;
+        int page;
+        if (hitOf(item, path, page)) emit hitDoubleClicked(path, page, m_query);
+    });
+}
+
+void LibrarySearchView::onSearch() {
+    QString text = m_field->text().trimmed();
+    m_results->clear();
+    if (text.isEmpty()) {
+        m_resultStatus->clear();
+        return;
+    }
+    if (LibraryIndex::tokenize(text).isEmpty()) {
+        m_resultStatus->setText("Запрос слишком короткий");
+        return;
+    }
+
+    m_query = text;
+    m_resultStatus->setText("...");
+    m_watcher->setFuture(m_index->query(text, MAX_HITS));
+}
+
+// Совпадения приходят отсортированными по файлу: файл — узел, страницы — дочерние элементы.
+void LibrarySearchView::onResults() {
+    const QList<LibraryHit> hits = m_watcher->result();
+    m_results->clear();
+    if (hits.isEmpty()) {
+        m_resultStatus->setText(m_index->isIndexing() ? "Ничего не найдено (индексация не завершена)" : "Ничего не найдено");
+        return;
+    }
+
+    QTreeWidgetItem *fileItem = nullptr;
+    int files = 0;
+    for (const LibraryHit &hit : hits) {
+        if (!fileItem || fileItem->data(0, Qt::UserRole).toString() != hit.path) {
+            fileItem = new QTreeWidgetItem(m_results);
+            fileItem->setText(0, QFileInfo(hit.path).fileName());
+            fileItem->setToolTip(0, hit.path);
+            fileItem->setData(0, Qt::UserRole, hit.path);
+            fileItem->setData(0, Qt::UserRole + 1, hit.page);
+            ++files;
+        }
+        QTreeWidgetItem *pageItem = new QTreeWidgetItem(fileItem);
+        pageItem->setText(0, QString("Стр. %1").arg(hit.page + 1));
+        pageItem->setData(0, Qt::UserRole, hit.path);
+        pageItem->setData(0, Qt::UserRole + 1, hit.page);
+    }
+    if (files <= 20) m_results->expandAll();
+
+    QString status = QString("Страниц: %1, файлов: %2").arg(hits.size()).arg(files);
+    if (hits.size() >= MAX_HITS) status += " (показаны первые)";
+    m_resultStatus->setText(status);
+}
+
+void LibrarySearchView::onProgress(int done, int total) {
+    if (total > 0 && done < total) {
+        m_indexStatus->setText(QString("Индексация: %1 из %2").arg(done).arg(total));
+    }
+}
+
+void LibrarySearchView::onIndexFinished() {
+    m_indexStatus->setText("Индекс библиотеки актуален");
+}
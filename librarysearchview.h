@@ -0,0 +1,50 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //librarysearchview.h
+#ifndef LIBRARYSEARCHVIEW_H
+#define LIBRARYSEARCHVIEW_H
+
+#include <QWidget>
+#include <QLineEdit>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QFutureWatcher>
+#include "libraryindex.h"
+
+// Поиск по всей библиотеке: файлы с совпадениями и их страницы.
+// Щелчок открывает страницу в режиме просмотра, двойной щелчок — в закреплённой вкладке.
+class LibrarySearchView : public QWidget {
+    Q_OBJECT
+public:
+    explicit LibrarySearchView(LibraryIndex *index, QWidget *parent = nullptr);
+    void focusIn() { m_field->setFocus(); m_field->selectAll(); }
+
+signals:
+    void hitSelected(const QString &filePath, int page, const QString &query);
+    void hitDoubleClicked(const QString &filePath, int page, const QString &query);
+
+private slots:
+    void onSearch();
+    void onResults();
+    void onProgress(int done, int total);
+    void onIndexFinished();
+
+private:
+    static const int MAX_HITS = 500;
+
+    LibraryIndex *m_index;
+    QLineEdit *m_field;
+    QLabel *m_indexStatus;
+    QLabel *m_resultStatus;
+    QTreeWidget *m_results;
+    QFutureWatcher<QList<LibraryHit>> *m_watcher;
+    QString m_query;
+};
+
+#endif // LIBRARYSEARCHVIEW_H
@@ -8,6 +8,7 @@
  */
 //librarysidebar.cpp
 #include "librarysidebar.h"
+#include "tracer.h"
 #include <QDirIterator>
 #include <QDebug>
 #include <QTreeWidgetItemIterator>
@@ -29,6 +30,8 @@ void LibrarySidebar::onItemClickedInternal(QTreeWidgetItem *item, int column) {
 }
 
 void LibrarySidebar::scanDirectory(const QString &path) {
+    TraceSpan span("LibrarySidebar::scanDirectory", "library");
+    if (span.isActive()) span.setArgs(QJsonObject{{"path", path}});
     clear();
     QDir mainDir(path);
     if (!mainDir.exists()) return;
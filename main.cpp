@@ -8,12 +8,21 @@
  */
 //main.cpp
 #include <QApplication>
+#include <QThreadPool>
 #include "mainwindow.h"
+#include "tracer.h"
 
 int main(int argc, char *argv[]) {
     QApplication a(argc, argv);
-    MainWindow w;
-    w.show();
-    return a.exec();
+    QThreadPool::globalInstance()->setExpiryTimeout(-1);
+    Tracer::start(Tracer::pathFromEnvironment(a.arguments()));
+    int result = 0;
+    {
+        MainWindow w;
+        w.show();
+        result = a.exec();
+    }
+    Tracer::stop();
+    return result;
 }
 
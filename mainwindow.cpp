@@ -8,6 +8,7 @@
  */
 //mainwindow.cpp
 #include "mainwindow.h"
+#include "tracer.h"
 #include <QMenuBar>
 #include <QMenu>
 #include <QAction>
@@ -20,6 +21,7 @@
 #include <QStandardPaths>
 #include <QShortcut>
 #include <QFileInfo>
+#include <QThreadPool>
 
 PdfTab::PdfTab(const QString &path, QWidget *parent) 
     : QWidget(parent), filePath(path) 
@@ -33,15 +35,47 @@ PdfTab::PdfTab(const QString &path, QWidget *parent)
     searchPanel->hide();
     searchPanel->setStyleSheet("background: #eee; border-top: 1px solid #ccc; padding: 5px;");
 
-    layout->addWidget(viewPort, 1);
+    thumbnails = new ThumbnailRenderer(this);
+    thumbnailPanel = new ThumbnailView(thumbnails, this);
+    thumbnailPanel->hide();
+    overview = new ThumbnailView(thumbnails, this);
+    overview->setGridMode(true);
+
+    pageStack = new QStackedWidget(this);
+    pageStack->addWidget(viewPort);
+    pageStack->addWidget(overview);
+
+    QHBoxLayout *pagesLayout = new QHBoxLayout();
+    pagesLayout->setContentsMargins(0, 0, 0, 0);
+    pagesLayout->setSpacing(0);
+    pagesLayout->addWidget(thumbnailPanel);
+    pagesLayout->addWidget(pageStack, 1);
+
+    layout->addLayout(pagesLayout, 1);
     layout->addWidget(searchPanel);
     
     connect(viewPort, &PdfViewPort::interacted, this, &PdfTab::pinRequested);
+    connect(viewPort, &PdfViewPort::pageInViewChanged, thumbnailPanel, &ThumbnailView::setCurrentPage);
+    connect(thumbnailPanel, &ThumbnailView::pageActivated, this, [this](int page) {
+        viewPort->goToPage(page);
+    });
+    connect(overview, &ThumbnailView::pageActivated, this, [this](int page) {
+        setOverviewMode(false);
+        viewPort->goToPage(page);
+    });
     connect(searchPanel, &PdfSearchPanel::pageFound, this, &PdfTab::pinRequested);
+    connect(searchPanel, &PdfSearchPanel::resultsChanged, viewPort, &PdfViewPort::setSearchResults);
+    connect(viewPort, &PdfViewPort::pageInViewChanged, searchPanel, &PdfSearchPanel::setCurrentPage);
 }
 
+// Закрытие не ждёт рабочие задачи: им выставляются флаги отмены, а пул
+// документов, которым они пользуются, освобождается вместе с последней
+// из них. Документ вкладки используется только GUI-потоком.
 PdfTab::~PdfTab() {
     viewPort->stopAllRenders();
+    thumbnails->abandonAll();
+    searchPanel->cancelSearch();
+    docPool.reset();
     QMutexLocker locker(&docMutex);
     if (doc) {
         delete doc;
@@ -50,7 +84,10 @@ PdfTab::~PdfTab() {
 }
 
 bool PdfTab::loadDocument() {
-    Poppler::Document *newDoc = Poppler::Document::load(filePath);
+    TraceSpan span("PdfTab::loadDocument", "open");
+    if (span.isActive()) span.setArgs(QJsonObject{{"path", filePath}});
+    QSharedPointer<DocumentPool> pool = QSharedPointer<DocumentPool>::create(filePath);
+    Poppler::Document *newDoc = pool->load();
     if (!newDoc || newDoc->isLocked()) {
         delete newDoc;
         return false;
@@ -59,28 +96,53 @@ bool PdfTab::loadDocument() {
     {
         QMutexLocker locker(&docMutex);
         doc = newDoc;
-        doc->setRenderBackend(Poppler::Document::SplashBackend);
+        pool->profile(ProfileHD).applyTo(doc);
     }
 
-    viewPort->setFilePath(filePath);
+    docPool = pool;
+    viewPort->setDocumentPool(docPool);
     viewPort->setDocument(doc, &docMutex);
+
+    thumbnails->setDevicePixelRatio(devicePixelRatioF());
+    thumbnails->setDocumentPool(docPool);
+    thumbnailPanel->setPageCount(viewPort->totalPages());
+    overview->setPageCount(viewPort->totalPages());
     
-    searchPanel->setFilePath(filePath);
+    searchPanel->setDocumentPool(docPool);
     searchPanel->setDocument(doc, &docMutex);
 
     return true;
 }
 
+void PdfTab::setOverviewMode(bool on) {
+    if (on) {
+        overview->setCurrentPage(viewPort->currentPage());
+        pageStack->setCurrentWidget(overview);
+        overview->setFocus();
+    } else {
+        pageStack->setCurrentWidget(viewPort);
+        viewPort->setFocus();
+    }
+}
+
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     loadSettings();
     setWindowTitle("Orion PDF Reader");
     resize(1030, 700);
 
+    m_libraryIndex = new LibraryIndex(this);
     setupUI();
     sidebar->scanDirectory(m_libraryPath); 
+    if (m_libraryIndexing) m_libraryIndex->setRoot(m_libraryPath);
 }
 
-MainWindow::~MainWindow() {}
+MainWindow::~MainWindow() {
+    // Вкладки удаляются раньше кэшей; отменённые задачи рендера ещё могут
+    // обращаться к дисковому кэшу, поэтому при выходе их дожидаемся.
+    while (tabWidget->count() > 0) delete tabWidget->widget(0);
+    m_libraryIndex->cancel();
+    QThreadPool::globalInstance()->waitForDone();
+}
 
 void MainWindow::setupUI() {
     QMenu *settingsMenu = menuBar()->addMenu("Настройки");
@@ -88,16 +150,55 @@ void MainWindow::setupUI() {
     QAction *setPathAction = new QAction("Путь к библиотеке...", this);
     connect(setPathAction, &QAction::triggered, this, &MainWindow::onChangeLibraryPath);
     settingsMenu->addAction(setPathAction);
+
+    QAction *diskCacheAction = new QAction("Дисковый кэш страниц", this);
+    diskCacheAction->setCheckable(true);
+    diskCacheAction->setChecked(m_diskCache.isEnabled());
+    connect(diskCacheAction, &QAction::toggled, this, [this](bool on) {
+        m_diskCache.setEnabled(on);
+        QSettings("OrionCorp", "PDFReader").setValue("diskCacheEnabled", on);
+    });
+    settingsMenu->addAction(diskCacheAction);
+
+    QAction *calibrationAction = new QAction("Автовыбор движка рендера", this);
+    calibrationAction->setCheckable(true);
+    calibrationAction->setChecked(m_renderCalibration);
+    connect(calibrationAction, &QAction::toggled, this, [this](bool on) {
+        m_renderCalibration = on;
+        QSettings("OrionCorp", "PDFReader").setValue("renderCalibration", on);
+    });
+    settingsMenu->addAction(calibrationAction);
+
+    QAction *libraryIndexAction = new QAction("Индексировать библиотеку", this);
+    libraryIndexAction->setCheckable(true);
+    libraryIndexAction->setChecked(m_libraryIndexing);
+    connect(libraryIndexAction, &QAction::toggled, this, [this](bool on) {
+        m_libraryIndexing = on;
+        QSettings("OrionCorp", "PDFReader").setValue("libraryIndexEnabled", on);
+        if (on) m_libraryIndex->setRoot(m_libraryPath);
+        else m_libraryIndex->cancel();
+    });
+    settingsMenu->addAction(libraryIndexAction);
     
     QSplitter *mainSplitter = new QSplitter(Qt::Horizontal, this);
     
     sidebar = new LibrarySidebar();
-    sidebar->setMinimumWidth(150);
-    sidebar->setMaximumWidth(500); 
+    librarySearch = new LibrarySearchView(m_libraryIndex);
+
+    leftTabs = new QTabWidget();
+    leftTabs->setDocumentMode(true);
+    leftTabs->setMinimumWidth(150);
+    leftTabs->setMaximumWidth(500); 
+    leftTabs->addTab(sidebar, "Файлы");
+    leftTabs->addTab(librarySearch, "Поиск");
 
     connect(sidebar, &LibrarySidebar::fileSelected, this, &MainWindow::openFilePreview);
     connect(sidebar, &LibrarySidebar::fileDoubleClicked, this, &MainWindow::openFilePinned);
     connect(sidebar, &LibrarySidebar::folderDoubleClicked, this, &MainWindow::openFilesPinned);
+    connect(librarySearch, &LibrarySearchView::hitSelected, this,
+            [this](const QString &path, int page, const QString &query) { openLibraryHit(path, page, query, true); });
+    connect(librarySearch, &LibrarySearchView::hitDoubleClicked, this,
+            [this](const QString &path, int page, const QString &query) { openLibraryHit(path, page, query, false); });
     
     QWidget *rightContainer = new QWidget();
     QVBoxLayout *rightLayout = new QVBoxLayout(rightContainer);
@@ -115,6 +216,20 @@ void MainWindow::setupUI() {
     btnShowSearch->setStyleSheet("QPushButton { border: 1px solid #ccc; border-radius: 4px; background: white; font-size: 16px; } QPushButton:hover { background: #eee; }");
     connect(btnShowSearch, &QPushButton::clicked, this, &MainWindow::toggleSearchPanel);
     topLayout->addWidget(btnShowSearch);
+
+    btnThumbnails = new QPushButton("▤");
+    btnThumbnails->setFixedSize(35, 35);
+    btnThumbnails->setToolTip("Миниатюры страниц");
+    btnThumbnails->setStyleSheet(btnShowSearch->styleSheet());
+    connect(btnThumbnails, &QPushButton::clicked, this, &MainWindow::toggleThumbnails);
+    topLayout->addWidget(btnThumbnails);
+
+    btnOverview = new QPushButton("▦");
+    btnOverview->setFixedSize(35, 35);
+    btnOverview->setToolTip("Обзор документа (Ctrl+G)");
+    btnOverview->setStyleSheet(btnShowSearch->styleSheet());
+    connect(btnOverview, &QPushButton::clicked, this, &MainWindow::toggleOverview);
+    topLayout->addWidget(btnOverview);
     topLayout->addStretch();
 
     zoomSpinBox = new QDoubleSpinBox();
@@ -153,7 +268,7 @@ void MainWindow::setupUI() {
     rightLayout->addWidget(topBar);
     rightLayout->addWidget(tabWidget, 1); 
 
-    mainSplitter->addWidget(sidebar);
+    mainSplitter->addWidget(leftTabs);
     mainSplitter->addWidget(rightContainer);
     mainSplitter->setCollapsible(0, false);
     mainSplitter->setStretchFactor(1, 1);
@@ -162,6 +277,21 @@ void MainWindow::setupUI() {
 
     QShortcut *searchShortcut = new QShortcut(QKeySequence("Ctrl+F"), this);
     connect(searchShortcut, &QShortcut::activated, this, &MainWindow::toggleSearchPanel);
+
+    QShortcut *librarySearchShortcut = new QShortcut(QKeySequence("Ctrl+Shift+F"), this);
+    connect(librarySearchShortcut, &QShortcut::activated, this, [this]() {
+        leftTabs->setCurrentWidget(librarySearch);
+        librarySearch->focusIn();
+    });
+
+    QShortcut *overviewShortcut = new QShortcut(QKeySequence("Ctrl+G"), this);
+    connect(overviewShortcut, &QShortcut::activated, this, &MainWindow::toggleOverview);
+
+    QShortcut *hudShortcut = new QShortcut(QKeySequence("F12"), this);
+    connect(hudShortcut, &QShortcut::activated, this, [this]() {
+        PdfTab *tab = currentTab();
+        if (tab) tab->viewPort->setHudVisible(!tab->viewPort->isHudVisible());
+    });
 }
 
 PdfTab* MainWindow::currentTab() const {
@@ -209,6 +339,7 @@ void MainWindow::internalOpenFile(const QString &filePath, bool preview) {
     if (preview && m_previewTab != nullptr) {
         int idx = tabWidget->indexOf(m_previewTab);
         if (idx != -1) {
+            releaseTab(m_previewTab);
             tabWidget->removeTab(idx);
             m_previewTab->deleteLater();
         }
@@ -216,10 +347,15 @@ void MainWindow::internalOpenFile(const QString &filePath, bool preview) {
     }
 
     PdfTab *newTab = new PdfTab(filePath, this);
+    newTab->viewPort->setPageCache(&m_pageCache);
+    newTab->viewPort->setDiskCache(&m_diskCache);
     if (!newTab->loadDocument()) {
         delete newTab;
         return;
     }
+    if (m_renderCalibration) {
+        RenderCalibrator::start(newTab->docPool);
+    }
 
     connect(newTab->viewPort, &PdfViewPort::pageInViewChanged, this, &MainWindow::onPageInViewChanged);
     connect(newTab->viewPort, &PdfViewPort::zoomRequested, this, &MainWindow::onZoomRequested);
@@ -255,6 +391,30 @@ void MainWindow::internalOpenFile(const QString &filePath, bool preview) {
     sidebar->selectFile(filePath);
 }
 
+// Вкладка открывается на странице совпадения, а поиск по документу
+// подсвечивает сам запрос, начиная с этой страницы.
+void MainWindow::openLibraryHit(const QString &filePath, int page, const QString &query, bool preview) {
+    internalOpenFile(filePath, preview);
+    PdfTab *tab = currentTab();
+    if (!tab || tab->filePath != filePath) return;
+
+    tab->viewPort->goToPage(page + 1);
+    tab->searchPanel->show();
+    tab->searchPanel->setCurrentPage(page + 1);
+    // Слова запроса в библиотеке могут стоять на странице порознь, поэтому
+    // в документе ищется первое из них, а не вся строка.
+    tab->searchPanel->search(LibraryIndex::tokenize(query).value(0, query));
+}
+
+// Страницы закрытого файла сразу уходят из общего кэша: они больше не
+// показываются, а при повторном открытии файл мог уже измениться.
+// Рендер останавливается раньше, чтобы поздние результаты не вернули их.
+void MainWindow::releaseTab(PdfTab *tab) {
+    if (!tab) return;
+    tab->viewPort->stopAllRenders();
+    m_pageCache.removeFile(tab->filePath);
+}
+
 void MainWindow::onTabCloseRequested(int index) {
     QWidget *w = tabWidget->widget(index);
 
@@ -262,6 +422,7 @@ void MainWindow::onTabCloseRequested(int index) {
         m_previewTab = nullptr;
     }
     
+    releaseTab(qobject_cast<PdfTab*>(w));
     tabWidget->removeTab(index);
     w->deleteLater();
     updateSidebarMarkers();
@@ -347,7 +508,8 @@ void MainWindow::onPageFoundInTab(int index, QString text, QRectF rect) {
         }
     }
     
-    tab->viewPort->updateHighlight(text, rect);
+    Q_UNUSED(text);
+    tab->viewPort->updateHighlight(index, rect);
     tab->viewPort->goToPage(index + 1, yFraction - 0.1);
 }
 
@@ -370,6 +532,21 @@ void MainWindow::toggleSearchPanel() {
     }
 }
 
+void MainWindow::toggleThumbnails() {
+    PdfTab *tab = currentTab();
+    if (!tab) return;
+    tab->thumbnailPanel->setVisible(!tab->thumbnailPanel->isVisible());
+    if (tab->thumbnailPanel->isVisible()) {
+        tab->thumbnailPanel->setCurrentPage(tab->viewPort->currentPage());
+    }
+}
+
+void MainWindow::toggleOverview() {
+    PdfTab *tab = currentTab();
+    if (!tab) return;
+    tab->setOverviewMode(!tab->isOverviewMode());
+}
+
 void MainWindow::onZoomSpinChanged(double value) {
     PdfTab *tab = currentTab();
     if (tab) {
@@ -391,6 +568,17 @@ void MainWindow::loadSettings() {
     if (defaultPath.isEmpty()) defaultPath = QDir::homePath();
 
     m_libraryPath = settings.value("libPath", defaultPath).toString();
+
+    qint64 cacheMB = settings.value("pageCacheMB", PageCache::DefaultBudget / (1024 * 1024)).toLongLong();
+    m_pageCache.setBudget(qMax<qint64>(cacheMB, 16) * 1024 * 1024);
+
+    m_diskCache.setEnabled(settings.value("diskCacheEnabled", false).toBool());
+    qint64 diskMB = settings.value("diskCacheMB", DiskCache::DefaultBudget / (1024 * 1024)).toLongLong();
+    m_diskCache.setBudget(qMax<qint64>(diskMB, 64) * 1024 * 1024);
+    m_renderCalibration = settings.value("renderCalibration", false).toBool();
+    m_libraryIndexing = settings.value("libraryIndexEnabled", true).toBool();
+    QString diskDir = settings.value("diskCacheDir").toString();
+    if (!diskDir.isEmpty()) m_diskCache.setDirectory(diskDir);
     
     if (!QDir(m_libraryPath).exists()) {
         m_libraryPath = defaultPath;
@@ -408,5 +596,6 @@ void MainWindow::onChangeLibraryPath() {
         m_libraryPath = dir;
         saveSettings();
         sidebar->scanDirectory(m_libraryPath);
+        if (m_libraryIndexing) m_libraryIndex->setRoot(m_libraryPath);
     }
 }
@@ -18,11 +18,17 @@
 #include <QMutex>
 #include <QTabWidget> 
 #include <QPointer>
+#include <QSharedPointer>
+#include <QStackedWidget>
 
 #include "librarysidebar.h"
 #include "pdfviewport.h"
 #include "pdfsearchpanel.h"
 #include "custom_widgets.h"
+#include "pagecache.h"
+#include "thumbnailview.h"
+#include "libraryindex.h"
+#include "librarysearchview.h"
 
 class PdfTab : public QWidget {
     Q_OBJECT
@@ -33,11 +39,18 @@ public:
     QString filePath;
     Poppler::Document *doc = nullptr;
     QMutex docMutex;
+    QSharedPointer<DocumentPool> docPool;
 
     PdfViewPort *viewPort = nullptr;
     PdfSearchPanel *searchPanel = nullptr;
+    ThumbnailRenderer *thumbnails = nullptr;
+    ThumbnailView *thumbnailPanel = nullptr;
+    ThumbnailView *overview = nullptr;
+    QStackedWidget *pageStack = nullptr;
 
     bool loadDocument();
+    void setOverviewMode(bool on);
+    bool isOverviewMode() const { return pageStack->currentWidget() == overview; }
 
 signals:
     void pinRequested();
@@ -63,6 +76,8 @@ private slots:
     void onZoomSpinChanged(double value);
     void onPageSpinChanged(int page);
     void toggleSearchPanel();
+    void toggleThumbnails();
+    void toggleOverview();
 
     void onChangeLibraryPath();
 
@@ -72,15 +87,26 @@ private:
     void setupUI();
     void updateSidebarMarkers();
     void internalOpenFile(const QString &filePath, bool preview);
+    void releaseTab(PdfTab *tab);
+    void openLibraryHit(const QString &filePath, int page, const QString &query, bool preview);
 
     PdfTab *m_previewTab = nullptr;
     QString m_libraryPath;
+    PageCache m_pageCache;
+    DiskCache m_diskCache;
+    bool m_renderCalibration = false;
+    bool m_libraryIndexing = true;
+    LibraryIndex *m_libraryIndex;
     QTabWidget *tabWidget; 
+    QTabWidget *leftTabs;
     LibrarySidebar *sidebar;
+    LibrarySearchView *librarySearch;
     InvertedSpinBox *pageSelector;
     QLabel *totalPagesLabel;
     QDoubleSpinBox *zoomSpinBox;
     QPushButton *btnShowSearch;
+    QPushButton *btnThumbnails;
+    QPushButton *btnOverview;
 
     PdfTab* currentTab() const;
 };
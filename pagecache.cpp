@@ -0,0 +1,91 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //pagecache.cpp
+#include "pagecache.h"
+#include <QHash>
+
+uint qHash(const PageCacheKey &key, uint seed) {
+    uint h = qHash(key.file, seed);
+    h = h * 31 + uint(key.page);
+    h = h * 31 + uint(key.width);
+    h = h * 31 + uint(key.height);
+    h = h * 31 + uint(key.quality);
+    h = h * 31 + uint(key.tile);
+    h = h * 31 + uint(key.profile);
+    return h;
+}
+
+// Стоимость в QCache считается в килобайтах: maxCost в Qt5 имеет тип int.
+PageCache::PageCache(qint64 budgetBytes) {
+    setBudget(budgetBytes);
+}
+
+void PageCache::setBudget(qint64 bytes) {
+    int before = m_cache.count();
+    m_cache.setMaxCost(int(qMax<qint64>(bytes / 1024, 1)));
+    m_evictions += before - m_cache.count();
+}
+
+qint64 PageCache::budget() const {
+    return qint64(m_cache.maxCost()) * 1024;
+}
+
+int PageCache::costOf(const QPixmap &pix) {
+    qint64 bytes = qint64(pix.width()) * pix.height() * pix.depth() / 8;
+    return int(qMax<qint64>(bytes / 1024, 1));
+}
+
+void PageCache::insert(const PageCacheKey &key, const QPixmap &pix) {
+    if (pix.isNull()) return;
+    bool existed = m_cache.contains(key);
+    int before = m_cache.count() + (existed ? 0 : 1);
+    if (!m_cache.insert(key, new QPixmap(pix), costOf(pix))) {
+        ++m_evictions;
+        return;
+    }
+    m_evictions += before - m_cache.count();
+}
+
+bool PageCache::lookup(const PageCacheKey &key) {
+    if (m_cache.object(key)) {
+        ++m_hits;
+        return true;
+    }
+    ++m_misses;
+    return false;
+}
+
+QPixmap PageCache::pixmap(const PageCacheKey &key) {
+    QPixmap *pix = m_cache.object(key);
+    return pix ? *pix : QPixmap();
+}
+
+void PageCache::removeFile(const QString &file) {
+    const QList<PageCacheKey> keys = m_cache.keys();
+    for (const PageCacheKey &key : keys) {
+        if (key.file == file) m_cache.remove(key);
+    }
+}
+
+PageCache::Stats PageCache::stats() const {
+    Stats s;
+    s.hits = m_hits;
+    s.misses = m_misses;
+    s.evictions = m_evictions;
+    s.usedBytes = qint64(m_cache.totalCost()) * 1024;
+    s.budgetBytes = budget();
+    s.count = m_cache.count();
+    return s;
+}
+
+void PageCache::resetStats() {
+    m_hits = 0;
+    m_misses = 0;
+    m_evictions = 0;
+}
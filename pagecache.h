@@ -0,0 +1,76 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //pagecache.h
+#ifndef PAGECACHE_H
+#define PAGECACHE_H
+
+#include <QCache>
+#include <QPixmap>
+#include <QString>
+
+struct PageCacheKey {
+    QString file;
+    int page = -1;
+    int width = 0;
+    int height = 0;
+    int quality = 0;
+    int tile = -1;
+    int profile = 0;
+
+    bool isValid() const { return page >= 0; }
+    bool operator==(const PageCacheKey &o) const {
+        return page == o.page && width == o.width && height == o.height && quality == o.quality
+            && tile == o.tile && profile == o.profile && file == o.file;
+    }
+    bool operator!=(const PageCacheKey &o) const { return !(*this == o); }
+};
+
+uint qHash(const PageCacheKey &key, uint seed = 0);
+
+// LRU-кэш отрисованных страниц с бюджетом в байтах, общий для всех вкладок.
+// Используется только из GUI-потока.
+class PageCache {
+public:
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        qint64 usedBytes = 0;
+        qint64 budgetBytes = 0;
+        int count = 0;
+    };
+
+    static const qint64 DefaultBudget = 256ll * 1024 * 1024;
+
+    explicit PageCache(qint64 budgetBytes = DefaultBudget);
+
+    void setBudget(qint64 bytes);
+    qint64 budget() const;
+
+    void insert(const PageCacheKey &key, const QPixmap &pix);
+    bool lookup(const PageCacheKey &key);
+    bool contains(const PageCacheKey &key) const { return m_cache.contains(key); }
+    QPixmap pixmap(const PageCacheKey &key);
+    void removeFile(const QString &file);
+
+    Stats stats() const;
+    void resetStats();
+
+private:
+    Q_DISABLE_COPY(PageCache)
+
+    static int costOf(const QPixmap &pix);
+
+    QCache<PageCacheKey, QPixmap> m_cache;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+    quint64 m_evictions = 0;
+};
+
+#endif // PAGECACHE_H
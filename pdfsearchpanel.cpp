@@ -8,7 +8,133 @@
  */
 //pdfsearchpanel.cpp
 #include "pdfsearchpanel.h"
+#include "tracer.h"
 #include <QtConcurrent>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+
+typedef QList<QPair<int, QRectF>> SearchHits;
+
+typedef QVector<int> PageChunk;
+
+// Поиск и построение текстового индекса идут в своём пуле, вдвое меньшем
+// глобального: поиск по большому документу не занимает потоки рендера
+// и миниатюр. Потоки не истекают: DocumentPool держит документ на каждый
+// поток до закрытия вкладки, и новый поток открывал бы ещё один.
+struct SearchThreadPool : QThreadPool {
+    SearchThreadPool() {
+        setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+        setExpiryTimeout(-1);
+    }
+};
+Q_GLOBAL_STATIC(SearchThreadPool, searchThreadPool)
+
+// Поиск по куску страниц. Если текстовый индекс готов, страницы ищутся
+// в нём; иначе каждый поток пула берёт свой документ из DocumentPool
+// и ищет тем же TextMatcher в разобранном тексте страниц, поэтому куски
+// ищутся параллельно и дают те же совпадения. У каждого поиска свой флаг отмены:
+// задачи устаревшего запроса видят его и завершаются.
+struct PageRangeSearch {
+    typedef SearchHits result_type;
+
+    TextMatcher matcher;
+    QSharedPointer<DocumentPool> pool;
+    QSharedPointer<const TextIndex> index;
+    QSharedPointer<QAtomicInt> canceled;
+
+    SearchHits operator()(const PageChunk &pages) const {
+        TraceSpan span("search chunk", "search");
+        if (span.isActive()) {
+            span.setArgs(QJsonObject{{"first", pages.first()}, {"last", pages.last()}, {"pages", pages.size()},
+                                     {"indexed", !index.isNull()}});
+        }
+        SearchHits results;
+        if (index) {
+            for (int i : pages) {
+                if (canceled->load() == 1) break;
+                for (const QRectF &rect : index->find(i, matcher)) {
+                    results.append(qMakePair(i, rect));
+                }
+            }
+            return results;
+        }
+
+        Poppler::Document *searchDoc = pool->acquire();
+        if (!searchDoc) return results;
+
+        QString text;
+        QVector<QRectF> boxes;
+        int total = searchDoc->numPages();
+        for (int i : pages) {
+            if (canceled->load() == 1) break;
+            if (i >= total) break;
+
+            Poppler::Page *page = searchDoc->page(i);
+            if (!page) continue;
+            TextIndex::extractText(page, text, boxes);
+            delete page;
+            for (const TextMatcher::Match &m : matcher.findAll(text)) {
+                for (const QRectF &rect : TextIndex::rectsForRange(boxes, m.offset, m.length)) {
+                    results.append(qMakePair(i, rect));
+                }
+            }
+        }
+        return results;
+    }
+};
+
+// Около четырёх кусков на поток, чтобы потоки с тяжёлыми страницами
+// не задерживали весь поиск. Куски упорядочены от текущей страницы наружу:
+// ближайшие совпадения находятся первыми. Страницы идут по возрастанию,
+// поэтому куски не перекрываются по номерам.
+static QVector<PageChunk> splitPages(const QVector<int> &pages, int aroundPage) {
+    QVector<PageChunk> chunks;
+    int threads = searchThreadPool()->maxThreadCount();
+    int total = pages.size();
+    int chunkSize = qBound(4, (total + threads * 4 - 1) / (threads * 4), 64);
+    for (int first = 0; first < total; first += chunkSize) {
+        chunks.append(pages.mid(first, chunkSize));
+    }
+    auto distance = [aroundPage](const PageChunk &c) {
+        if (aroundPage < c.first()) return c.first() - aroundPage;
+        if (aroundPage > c.last()) return aroundPage - c.last();
+        return 0;
+    };
+    std::stable_sort(chunks.begin(), chunks.end(), [&distance](const PageChunk &a, const PageChunk &b) {
+        return distance(a) < distance(b);
+    });
+    return chunks;
+}
+
+// Куски разбирают несколько задач пула поиска; результат каждого куска
+// сообщается под его номером, как это делает QtConcurrent::mapped.
+static QFuture<SearchHits> startSearch(const QVector<PageChunk> &chunks, const PageRangeSearch &search) {
+    QFutureInterface<SearchHits> iface;
+    iface.reportStarted();
+    QFuture<SearchHits> future = iface.future();
+
+    QThreadPool *threads = searchThreadPool();
+    int workers = qMin(chunks.size(), threads->maxThreadCount());
+    if (workers == 0) {
+        iface.reportFinished();
+        return future;
+    }
+    QSharedPointer<QAtomicInt> next = QSharedPointer<QAtomicInt>::create(0);
+    QSharedPointer<QAtomicInt> running = QSharedPointer<QAtomicInt>::create(workers);
+    for (int w = 0; w < workers; ++w) {
+        QtConcurrent::run(threads, [chunks, search, iface, next, running]() {
+            QFutureInterface<SearchHits> fi(iface);
+            QThread::currentThread()->setPriority(QThread::LowPriority);
+            for (int i = next->fetchAndAddRelaxed(1); i < chunks.size(); i = next->fetchAndAddRelaxed(1)) {
+                if (search.canceled->load() == 1) break;
+                fi.reportResult(search(chunks[i]), i);
+            }
+            if (!running->deref()) fi.reportFinished();
+        });
+    }
+    return future;
+}
 
 PdfSearchPanel::PdfSearchPanel(QWidget *parent) : QWidget(parent) {
     QHBoxLayout *layout = new QHBoxLayout(this);
@@ -18,6 +144,19 @@ PdfSearchPanel::PdfSearchPanel(QWidget *parent) : QWidget(parent) {
     searchField->setPlaceholderText("Поиск по документу...");
     searchField->setFixedWidth(300);
     
+    auto optionBox = [this](const QString &text, const QString &tip) {
+        QCheckBox *box = new QCheckBox(text);
+        box->setToolTip(tip);
+        connect(box, &QCheckBox::toggled, this, [this]() {
+            if (!searchField->text().trimmed().isEmpty()) onFindStart();
+        });
+        return box;
+    };
+    chkCase = optionBox("Aa", "Учитывать регистр");
+    chkWholeWords = optionBox("Слово", "Только целые слова");
+    chkDiacritics = optionBox("é=e", "Без учёта диакритики");
+    chkRegex = optionBox(".*", "Регулярное выражение");
+
     btnStart = new QPushButton("Найти");
     lblStatus = new QLabel("");
     lblStatus->setStyleSheet("font-weight: bold; color: #2980b9;");
@@ -41,12 +180,24 @@ PdfSearchPanel::PdfSearchPanel(QWidget *parent) : QWidget(parent) {
     navWidget->setVisible(false);
 
     layout->addWidget(searchField);
+    layout->addWidget(chkCase);
+    layout->addWidget(chkWholeWords);
+    layout->addWidget(chkDiacritics);
+    layout->addWidget(chkRegex);
     layout->addWidget(btnStart);
     layout->addWidget(navWidget);
     layout->addWidget(btnClose);
 
     searchWatcher = new QFutureWatcher<QList<QPair<int, QRectF>>>(this);
+    connect(searchWatcher, &QFutureWatcher<QList<QPair<int, QRectF>>>::resultsReadyAt, this, &PdfSearchPanel::onResultsReady);
     connect(searchWatcher, &QFutureWatcher<QList<QPair<int, QRectF>>>::finished, this, &PdfSearchPanel::onSearchFinished);
+    m_indexWatcher = new QFutureWatcher<QSharedPointer<TextIndex>>(this);
+    connect(m_indexWatcher, &QFutureWatcher<QSharedPointer<TextIndex>>::finished, this, &PdfSearchPanel::onIndexReady);
+    m_typeTimer = new QTimer(this);
+    m_typeTimer->setSingleShot(true);
+    m_typeTimer->setInterval(TYPE_DELAY_MS);
+    connect(m_typeTimer, &QTimer::timeout, this, &PdfSearchPanel::onTypingPaused);
+    connect(searchField, &QLineEdit::textEdited, m_typeTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
     connect(btnStart, &QPushButton::clicked, this, &PdfSearchPanel::onFindStart);
     connect(searchField, &QLineEdit::returnPressed, this, &PdfSearchPanel::onFindStart);
     connect(btnNext, &QPushButton::clicked, this, &PdfSearchPanel::onNext);
@@ -55,8 +206,30 @@ PdfSearchPanel::PdfSearchPanel(QWidget *parent) : QWidget(parent) {
     connect(btnClose, &QPushButton::clicked, this, &PdfSearchPanel::hide);
 }
 
-void PdfSearchPanel::setFilePath(const QString &path) {
-    m_currentDocPath = path;
+PdfSearchPanel::~PdfSearchPanel() {
+    cancelSearch();
+    if (m_indexCanceled) m_indexCanceled->store(1);
+}
+
+// Индекс загружается с диска или строится в фоне; до его готовности
+// поиск идёт через Poppler. Задача не обращается к панели и держит
+// пул сама, поэтому панель может быть удалена раньше неё.
+void PdfSearchPanel::setDocumentPool(const QSharedPointer<DocumentPool> &pool) {
+    if (m_indexCanceled) m_indexCanceled->store(1);
+    m_docPool = pool;
+    m_textIndex.reset();
+    if (!pool) return;
+
+    QSharedPointer<QAtomicInt> canceled = QSharedPointer<QAtomicInt>::create(0);
+    m_indexCanceled = canceled;
+    m_indexWatcher->setFuture(QtConcurrent::run(searchThreadPool(), [pool, canceled]() {
+        return TextIndex::loadOrBuild(pool.data(), canceled.data());
+    }));
+}
+
+void PdfSearchPanel::onIndexReady() {
+    if (!m_indexCanceled || m_indexCanceled->load() == 1) return;
+    m_textIndex = m_indexWatcher->result();
 }
 
 void PdfSearchPanel::setDocument(Poppler::Document *newDoc, QMutex *mutex) {
@@ -64,77 +237,186 @@ void PdfSearchPanel::setDocument(Poppler::Document *newDoc, QMutex *mutex) {
     doc = newDoc;
     docMutex = mutex;
     onReset();
+    m_completedQuery.clear();
+    m_completedPages.clear();
 }
 
 void PdfSearchPanel::cancelSearch() {
-    currentSearchCanceled.store(1);
-    if (searchWatcher->isRunning()) searchWatcher->waitForFinished(); 
+    m_typeTimer->stop();
+    if (m_searchCanceled) m_searchCanceled->store(1);
 }
 
 void PdfSearchPanel::onFindStart() {
+    m_typeTimer->stop();
     QString text = searchField->text().trimmed();
-    if (text.isEmpty() || m_currentDocPath.isEmpty()) return;
+    if (text.isEmpty() || !m_docPool) return;
+
+    TextMatcher::Options options;
+    if (chkCase->isChecked()) options |= TextMatcher::CaseSensitive;
+    if (chkWholeWords->isChecked()) options |= TextMatcher::WholeWords;
+    if (chkDiacritics->isChecked()) options |= TextMatcher::IgnoreDiacritics;
+    if (chkRegex->isChecked()) options |= TextMatcher::RegularExpression;
+    TextMatcher matcher(text, options);
+
+    // Уточнение завершённого запроса: каждая страница с новым запросом
+    // содержит и старый, поэтому достаточно перепроверить страницы,
+    // где старый уже был найден. Для целых слов и выражений это неверно.
+    QVector<int> pages;
+    bool refine = !m_completedQuery.isEmpty() && options == m_completedOptions
+        && !(options & (TextMatcher::WholeWords | TextMatcher::RegularExpression));
+    if (refine) {
+        Qt::CaseSensitivity cs = (options & TextMatcher::CaseSensitive) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+        if (options & TextMatcher::IgnoreDiacritics) {
+            refine = TextMatcher::foldDiacritics(text).contains(TextMatcher::foldDiacritics(m_completedQuery), cs);
+        } else {
+            refine = text.contains(m_completedQuery, cs);
+        }
+    }
+    if (refine) {
+        pages = m_completedPages;
+    } else {
+        int total = 0;
+        if (doc && docMutex) {
+            QMutexLocker locker(docMutex);
+            total = doc->numPages();
+        }
+        pages.reserve(total);
+        for (int i = 0; i < total; ++i) pages.append(i);
+    }
 
     onReset();
-    currentSearchCanceled.store(0);
+    navWidget->setVisible(true);
+    if (!matcher.isValid()) {
+        lblStatus->setText("Ошибка в выражении");
+        lblStatus->setToolTip(matcher.errorString());
+        return;
+    }
+    lblStatus->setToolTip(QString());
+
+    m_searchCanceled = QSharedPointer<QAtomicInt>::create(0);
+    m_searchText = text;
+    m_searchOptions = options;
+    m_scanning = true;
     lblStatus->setText("...");
     btnStart->setEnabled(false);
 
-    QString localPath = m_currentDocPath;
+    PageRangeSearch search;
+    search.matcher = matcher;
+    search.pool = m_docPool;
+    if (m_textIndex && doc) search.index = m_textIndex;
+    search.canceled = m_searchCanceled;
+    if (search.index) {
+        QMutexLocker locker(docMutex);
+        if (m_textIndex->pageCount() != doc->numPages()) search.index.reset();
+    }
 
-    QFuture<QList<QPair<int, QRectF>>> future = QtConcurrent::run([this, text, localPath]() {
-        QList<QPair<int, QRectF>> results;
-        Poppler::Document *searchDoc = Poppler::Document::load(localPath);
-        if (!searchDoc) return results;
+    searchWatcher->setFuture(startSearch(splitPages(pages, m_currentPage), search));
+}
 
-        for (int i = 0; i < searchDoc->numPages(); ++i) {
-            if (this->currentSearchCanceled.load() == 1) break;
-            
-            Poppler::Page *page = searchDoc->page(i);
-            if (page) {
-                QList<QRectF> found = page->search(text, Poppler::Page::IgnoreCase);
-                for (const QRectF &rect : found) {
-                    results.append(qMakePair(i, rect));
+// Живой поиск по паузе в наборе; один символ не ищется, чтобы не
+// сканировать документ ради почти всех страниц.
+void PdfSearchPanel::onTypingPaused() {
+    QString text = searchField->text().trimmed();
+    if (text.isEmpty()) {
+        onReset();
+        m_completedQuery.clear();
+        m_completedPages.clear();
+        lblStatus->clear();
+        return;
+    }
+    if (text.size() < LIVE_MIN_CHARS || text == m_searchText) return;
+    onFindStart();
+}
+
+void PdfSearchPanel::search(const QString &text) {
+    searchField->setText(text);
+    onFindStart();
+}
+
+void PdfSearchPanel::setCurrentPage(int page) {
+    m_currentPage = qMax(0, page - 1);
+}
+
+// Куски приходят в порядке готовности; совпадения вставляются так, чтобы
+// список оставался упорядоченным по страницам, а текущее совпадение не
+// сдвигалось. К первому найденному совпадению сразу выполняется переход.
+void PdfSearchPanel::onResultsReady(int begin, int end) {
+    if (!m_searchCanceled || m_searchCanceled->load() == 1) return;
+
+    bool added = false;
+    for (int i = begin; i < end; ++i) {
+        const SearchHits hits = searchWatcher->resultAt(i);
+        if (hits.isEmpty()) continue;
+
+        auto pos = std::lower_bound(searchResults.begin(), searchResults.end(), hits.first().first,
+                                    [](const QPair<int, QRectF> &hit, int page) { return hit.first < page; });
+        int insertAt = int(pos - searchResults.begin());
+        for (int k = 0; k < hits.size(); ++k) {
+            searchResults.insert(insertAt + k, hits[k]);
+        }
+        if (currentIndex >= insertAt) currentIndex += hits.size();
+
+        if (currentIndex < 0) {
+            currentIndex = insertAt;
+            for (int k = 0; k < hits.size(); ++k) {
+                if (hits[k].first >= m_currentPage) {
+                    currentIndex = insertAt + k;
+                    break;
                 }
-                delete page;
             }
+            emit pageFound(searchResults[currentIndex].first, m_searchText, searchResults[currentIndex].second);
         }
-        delete searchDoc;
-        return results;
-    });
-    searchWatcher->setFuture(future);
+        added = true;
+    }
+
+    if (added) {
+        emit resultsChanged(searchResults);
+        updateStatus();
+    }
 }
 
 void PdfSearchPanel::onSearchFinished() {
     btnStart->setEnabled(true);
-    if (currentSearchCanceled.load() == 1) return;
-    searchResults = searchWatcher->result();
-    navWidget->setVisible(true);
+    if (!m_searchCanceled || m_searchCanceled->load() == 1) return;
+    m_scanning = false;
+
+    m_completedQuery = m_searchText;
+    m_completedOptions = m_searchOptions;
+    m_completedPages.clear();
+    for (const QPair<int, QRectF> &hit : searchResults) {
+        if (m_completedPages.isEmpty() || m_completedPages.last() != hit.first) m_completedPages.append(hit.first);
+    }
+    updateStatus();
+}
+
+void PdfSearchPanel::updateStatus() {
     if (searchResults.isEmpty()) {
-        lblStatus->setText("0/0");
-    } else {
-        currentIndex = 0;
-        lblStatus->setText(QString("1/%1").arg(searchResults.size()));
-        emit pageFound(searchResults[0].first, searchField->text(), searchResults[0].second);
+        lblStatus->setText(m_scanning ? "..." : "0/0");
+        return;
     }
+    QString text = QString("%1/%2").arg(currentIndex + 1).arg(searchResults.size());
+    if (m_scanning) text += "…";
+    lblStatus->setText(text);
 }
 
 void PdfSearchPanel::onNext() {
     if (searchResults.isEmpty()) return;
     currentIndex = (currentIndex + 1) % searchResults.size();
-    lblStatus->setText(QString("%1/%2").arg(currentIndex + 1).arg(searchResults.size()));
-    emit pageFound(searchResults[currentIndex].first, searchField->text(), searchResults[currentIndex].second);
+    updateStatus();
+    emit pageFound(searchResults[currentIndex].first, m_searchText, searchResults[currentIndex].second);
 }
 
 void PdfSearchPanel::onPrev() {
     if (searchResults.isEmpty()) return;
     currentIndex = (currentIndex - 1 + searchResults.size()) % searchResults.size();
-    lblStatus->setText(QString("%1/%2").arg(currentIndex + 1).arg(searchResults.size()));
-    emit pageFound(searchResults[currentIndex].first, searchField->text(), searchResults[currentIndex].second);
+    updateStatus();
+    emit pageFound(searchResults[currentIndex].first, m_searchText, searchResults[currentIndex].second);
 }
 
 void PdfSearchPanel::onReset() {
-    currentSearchCanceled.store(1);
+    if (m_searchCanceled) m_searchCanceled->store(1);
+    m_searchText.clear();
+    m_scanning = false;
     searchResults.clear();
     currentIndex = -1;
     navWidget->setVisible(false);
@@ -13,30 +13,46 @@
 #include <QWidget>
 #include <QLineEdit>
 #include <QPushButton>
+#include <QCheckBox>
 #include <QLabel>
+#include <QTimer>
+#include <QVector>
 #include <QHBoxLayout>
 #include <QPair>
 #include <QMutex>
 #include <QFutureWatcher>
 #include <QAtomicInt>
+#include <QSharedPointer>
 #include <poppler-qt5.h>
+#include "documentpool.h"
+#include "textindex.h"
+#include "textmatcher.h"
 
 class PdfSearchPanel : public QWidget {
     Q_OBJECT
 public:
     explicit PdfSearchPanel(QWidget *parent = nullptr);
+    ~PdfSearchPanel();
     void setDocument(Poppler::Document *newDoc, QMutex *mutex); 
     void cancelSearch();
-    void setFilePath(const QString &path);
+    void setDocumentPool(const QSharedPointer<DocumentPool> &pool);
     void focusIn() { searchField->setFocus(); }
+    void search(const QString &text);
+
+public slots:
+    void setCurrentPage(int page);
 
 signals:
     void pageFound(int pageIndex, QString text, QRectF rect);
+    void resultsChanged(const QList<QPair<int, QRectF>> &results);
     void searchReset(); 
 
 private slots:
     void onFindStart();
+    void onTypingPaused();
+    void onResultsReady(int begin, int end);
     void onSearchFinished(); 
+    void onIndexReady();
     void onNext();
     void onPrev();
     void onReset();
@@ -44,19 +60,37 @@ private slots:
 private:
     Poppler::Document *doc = nullptr;
     QMutex *docMutex = nullptr;
-    QString m_currentDocPath;
+    QSharedPointer<DocumentPool> m_docPool;
 
     QLineEdit *searchField;
     QPushButton *btnStart;
     QLabel *lblStatus;
     QWidget *navWidget;
     QPushButton *btnNext, *btnPrev, *btnReset;
+    QCheckBox *chkCase, *chkWholeWords, *chkDiacritics, *chkRegex;
     
+    void updateStatus();
+
     QList<QPair<int, QRectF>> searchResults; 
     int currentIndex = -1;
+    QString m_searchText;
+    int m_currentPage = 0;
+    bool m_scanning = false;
 
     QFutureWatcher<QList<QPair<int, QRectF>>> *searchWatcher;
-    QAtomicInt currentSearchCanceled; 
+    QSharedPointer<QAtomicInt> m_searchCanceled;
+
+    static const int TYPE_DELAY_MS = 250;
+    static const int LIVE_MIN_CHARS = 2;
+    QTimer *m_typeTimer;
+    TextMatcher::Options m_searchOptions;
+    QString m_completedQuery;
+    TextMatcher::Options m_completedOptions;
+    QVector<int> m_completedPages;
+
+    QSharedPointer<const TextIndex> m_textIndex;
+    QFutureWatcher<QSharedPointer<TextIndex>> *m_indexWatcher;
+    QSharedPointer<QAtomicInt> m_indexCanceled;
 };
 
 #endif // PDFSEARCHPANEL_H
@@ -8,393 +8,745 @@
  */
  //pdfviewport.cpp
 #include "pdfviewport.h"
+#include "tracer.h"
 #include <QPainter>
-#include <QtConcurrent>
 #include <QApplication>
+#include <QtMath>
+#include <QtConcurrent>
+#include <QKeyEvent>
+#include <algorithm>
+#include <utility>
+
+const int TILE_SIZE = 512;
+const qint64 TILE_MODE_MIN_PIXELS = 2048 * 2048;
+const int PAGE_SPACING = 20;
+const int SIZE_BATCH = 256;
+// Сколько миллисекунд прокрутки вперёд держать подготовленными.
+const int PREFETCH_LOOKAHEAD_MS = 600;
+const int VELOCITY_IDLE_MS = 250;
+const double VELOCITY_MIN = 0.05;
+
+PdfViewPort::PdfViewPort(QWidget *parent) : QAbstractScrollArea(parent) {
+    renderTimer = new QTimer(this);
+    renderTimer->setSingleShot(true);
+    renderTimer->setInterval(100);
 
-const double MAX_DPI = 400.0;
-const double DRAFT_DPI = 72.0; 
-
-enum RenderQuality {
-    QualityDraft,
-    QualityHD
-};
+    renderQueue = new RenderQueue(this);
 
-PdfViewPort::PdfViewPort(QWidget *parent) : QScrollArea(parent) {
-    setWidgetResizable(true);
-    setAlignment(Qt::AlignHCenter);
-    setStyleSheet("QScrollArea { background-color: #525659; border: none; }");
-    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+    zoomTimer = new QTimer(this);
+    zoomTimer->setSingleShot(true);
+    zoomTimer->setInterval(16);
+    connect(zoomTimer, &QTimer::timeout, this, &PdfViewPort::performZoomOrResize);
 
-    scrollContainer = new QWidget();
-    scrollLayout = new QVBoxLayout(scrollContainer);
-    scrollLayout->setContentsMargins(0, 20, 0, 20);
-    scrollLayout->setSpacing(20);
-    scrollLayout->setAlignment(Qt::AlignHCenter);
-    setWidget(scrollContainer);
+    m_sizeWatcher = new QFutureWatcher<QVector<QSizeF>>(this);
+    connect(m_sizeWatcher, &QFutureWatcher<QVector<QSizeF>>::resultReadyAt, this, &PdfViewPort::onPageSizesReady);
 
-    renderTimer = new QTimer(this);
-    renderTimer->setSingleShot(true);
-    renderTimer->setInterval(100);
+    setStyleSheet("QAbstractScrollArea { background-color: #525659; border: none; }");
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+    verticalScrollBar()->setSingleStep(20);
+    horizontalScrollBar()->setSingleStep(20);
     
     connect(renderTimer, &QTimer::timeout, this, &PdfViewPort::onRenderTimeout);
+    connect(renderQueue, &RenderQueue::jobFinished, this, &PdfViewPort::onRenderFinished);
     connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &PdfViewPort::onScrollValueChanged);
     connect(verticalScrollBar(), &QScrollBar::sliderPressed, this, &PdfViewPort::interacted);
+    connect(horizontalScrollBar(), &QScrollBar::valueChanged, this, [this](){
+        updateVisiblePages(false);
+        renderTimer->start(100);
+    });
 }
 
 PdfViewPort::~PdfViewPort() {
+    m_sizeWatcher->future().cancel();
     stopAllRenders();
 }
 
 void PdfViewPort::stopAllRenders() {
-    for (auto *w : activeRenders.values()) {
-        w->disconnect();
-        w->waitForFinished();
-        w->deleteLater();
-    }
-    activeRenders.clear();
+    renderQueue->abandonAll();
 }
 
 void PdfViewPort::cancelAllRenders() {
-    for (auto *w : activeRenders.values()) {
-        w->disconnect();
-        w->deleteLater();
-    }
-    activeRenders.clear();
+    renderQueue->cancelAll();
 }
 
 void PdfViewPort::setDocument(Poppler::Document *doc, QMutex *mutex) {
+    TraceSpan span("PdfViewPort::setDocument", "open");
     stopAllRenders();
+    m_sizeWatcher->future().cancel();
     m_doc = doc;
     m_docMutex = mutex;
     
     m_originalPageSizes.clear();
-    clearLayout();
+    m_searchHits.clear();
+    m_activeHitPage = -1;
+    m_pageTops.clear();
+    m_pageHeights.clear();
+    releaseAllWidgets();
     
     if (m_doc) {
         int total = 0;
+        QSizeF estimate(600, 800);
         {
             QMutexLocker locker(m_docMutex);
             total = m_doc->numPages();
-            for (int i = 0; i < total; ++i) {
-                Poppler::Page *p = m_doc->page(i);
-                if (p) {
-                    m_originalPageSizes.append(p->pageSize());
-                    delete p;
-                } else {
-                    m_originalPageSizes.append(QSize(600, 800));
-                }
+            Poppler::Page *p = total > 0 ? m_doc->page(0) : nullptr;
+            if (p) {
+                estimate = p->pageSizeF();
+                delete p;
             }
         }
-
-        for (int i = 0; i < total; ++i) {
-            PageWidget *pw = new PageWidget();
-            scrollLayout->addWidget(pw);
-            pageLabels.append(pw);
-        }
+        m_originalPageSizes.fill(estimate, total);
+        startPageSizeDiscovery(total);
 
         performZoomOrResize();
+        m_ignoreScrollDelta = true;
         verticalScrollBar()->setValue(0);
+        m_ignoreScrollDelta = false;
         
         renderTimer->start(50);
+    } else {
+        updateScrollBars();
     }
 }
 
-void PdfViewPort::setFilePath(const QString &path) {
-    m_docPath = path;
+void PdfViewPort::setPageCache(PageCache *cache) {
+    m_pageCache = cache;
+}
+
+void PdfViewPort::setDiskCache(DiskCache *cache) {
+    renderQueue->setDiskCache(cache);
+}
+
+void PdfViewPort::setDocumentPool(const QSharedPointer<DocumentPool> &pool) {
+    m_docPool = pool;
+    renderQueue->setDocumentPool(pool);
 }
 
 void PdfViewPort::setZoom(double zoom) {
     if (qAbs(m_currentZoom - zoom) < 0.001) return;
     m_currentZoom = zoom;
-    performZoomOrResize();
+    if (!zoomTimer->isActive()) zoomTimer->start();
 }
 
 void PdfViewPort::resizeEvent(QResizeEvent *event) {
-    QScrollArea::resizeEvent(event);
-    performZoomOrResize(); 
+    QAbstractScrollArea::resizeEvent(event);
+    if (!zoomTimer->isActive()) zoomTimer->start();
 }
 
 void PdfViewPort::showEvent(QShowEvent *event) {
-    QScrollArea::showEvent(event);
+    QAbstractScrollArea::showEvent(event);
     performZoomOrResize();
 }
 
+void PdfViewPort::scrollContentsBy(int dx, int dy) {
+    Q_UNUSED(dx);
+    Q_UNUSED(dy);
+    layoutVisibleWidgets();
+}
+
 void PdfViewPort::onRenderTimeout() {
     updateVisiblePages(true);
 }
 
 void PdfViewPort::onScrollValueChanged(int value) {
-    Q_UNUSED(value);
-    if (pageLabels.isEmpty()) return;
+    if (m_pageTops.isEmpty()) return;
 
-    QScrollBar *bar = verticalScrollBar();
-    int foundPage = -1;
-    if (value <= 15) {
-        foundPage = 1;
-    } else if (value >= bar->maximum() - 15) {
-        foundPage = pageLabels.size();
-    } else {
-        int readingLineY = value + (viewport()->height() * 0.2);
-        for (int i = 0; i < pageLabels.size(); ++i) {
-            QRect g = pageLabels[i]->geometry();
-            if (readingLineY >= g.top() && readingLineY <= (g.bottom() + scrollLayout->spacing())) {
-                foundPage = i + 1;
-                break;
-            }
-        }
-    }
-    if (foundPage != -1) {
-        emit pageInViewChanged(foundPage);
-    }
-    
+    emit pageInViewChanged(currentPage());
+
+    trackScrollVelocity(value);
     updateVisiblePages(false);
     
     renderTimer->start(100);
 }
 
 void PdfViewPort::performZoomOrResize() {
-    if (pageLabels.isEmpty() || !m_doc) return;
+    zoomTimer->stop();
+    if (m_originalPageSizes.isEmpty() || !m_doc) return;
 
     cancelAllRenders();
-    scrollContainer->setUpdatesEnabled(false);
+    relayoutKeepingAnchor();
+    
+    QTimer::singleShot(10, this, [this](){ updateVisiblePages(false); });
+    renderTimer->start(100); 
+}
 
+void PdfViewPort::relayoutKeepingAnchor() {
     int scrollY = verticalScrollBar()->value();
     int currentPageIdx = 0;
     double relativeOffset = 0.0;
-    
-    for (int i = 0; i < pageLabels.size(); ++i) {
-        QRect g = pageLabels[i]->geometry();
-        if (scrollY < g.bottom()) {
-            currentPageIdx = i;
-            if (g.height() > 0) relativeOffset = double(scrollY - g.top()) / g.height();
-            break;
-        }
+    if (!m_pageTops.isEmpty()) {
+        currentPageIdx = pageAt(scrollY);
+        int h = m_pageHeights[currentPageIdx];
+        if (h > 0) relativeOffset = double(scrollY - m_pageTops[currentPageIdx]) / h;
     }
 
-    updateGridHelper();
-    
-    this->setAlignment(Qt::AlignHCenter);
-    scrollLayout->setAlignment(Qt::AlignHCenter);
+    rebuildLayout();
+
+    int newY = m_pageTops[currentPageIdx] + qRound(m_pageHeights[currentPageIdx] * relativeOffset);
+    m_ignoreScrollDelta = true;
+    verticalScrollBar()->setValue(newY);
+    m_ignoreScrollDelta = false;
+    layoutVisibleWidgets();
+}
 
-    scrollContainer->layout()->activate();
-    scrollContainer->adjustSize();
+void PdfViewPort::startPageSizeDiscovery(int total) {
+    QFutureInterface<QVector<QSizeF>> iface;
+    iface.reportStarted();
+    m_sizeWatcher->setFuture(iface.future());
+
+    QSharedPointer<DocumentPool> pool = m_docPool;
+    QtConcurrent::run([pool, total, iface]() {
+        QFutureInterface<QVector<QSizeF>> fi(iface);
+        Poppler::Document *doc = pool ? pool->acquire() : nullptr;
+        for (int batch = 0; doc && batch * SIZE_BATCH < total; ++batch) {
+            if (fi.isCanceled()) break;
+            QVector<QSizeF> sizes;
+            int end = qMin(total, (batch + 1) * SIZE_BATCH);
+            for (int i = batch * SIZE_BATCH; i < end; ++i) {
+                Poppler::Page *p = doc->page(i);
+                if (p) {
+                    sizes.append(p->pageSizeF());
+                    delete p;
+                } else {
+                    sizes.append(QSizeF(600, 800));
+                }
+            }
+            fi.reportResult(sizes, batch);
+        }
+        fi.reportFinished();
+    });
+}
 
-    if (currentPageIdx < pageLabels.size()) {
-        int newY = pageLabels[currentPageIdx]->y() + qRound(pageLabels[currentPageIdx]->height() * relativeOffset);
-        verticalScrollBar()->setValue(newY);
+void PdfViewPort::onPageSizesReady(int batch) {
+    QVector<QSizeF> sizes = m_sizeWatcher->resultAt(batch);
+    int start = batch * SIZE_BATCH;
+    bool changed = false;
+    for (int k = 0; k < sizes.size() && start + k < m_originalPageSizes.size(); ++k) {
+        QSizeF size = sizes[k];
+        if (size.isEmpty()) continue;
+        if (m_originalPageSizes[start + k] != size) {
+            m_originalPageSizes[start + k] = size;
+            changed = true;
+        }
     }
+    if (!changed || m_pageTops.isEmpty()) return;
 
-    scrollContainer->setUpdatesEnabled(true);
-    
-    QTimer::singleShot(10, [this](){ updateVisiblePages(false); });
-    renderTimer->start(100); 
+    relayoutKeepingAnchor();
+    for (auto it = m_pageWidgets.constBegin(); it != m_pageWidgets.constEnd(); ++it) {
+        applyHighlights(it.key(), it.value());
+    }
+    updateVisiblePages(false);
+    renderTimer->start(100);
 }
 
-void PdfViewPort::updateGridHelper() {
-    if (pageLabels.isEmpty() || m_originalPageSizes.isEmpty()) return;
-
+void PdfViewPort::rebuildLayout() {
     int viewW = viewport()->width();
     int availableWidth = viewW - 25; 
     if (availableWidth < 100) availableWidth = 100;
 
-    int targetWidth = qRound(availableWidth * m_currentZoom);
+    m_pageWidth = qRound(availableWidth * m_currentZoom);
+
+    int total = m_originalPageSizes.size();
+    m_pageTops.resize(total);
+    m_pageHeights.resize(total);
 
-    for (int i = 0; i < pageLabels.size(); ++i) {
-        QSize originalSize = m_originalPageSizes[i];
+    int y = PAGE_SPACING;
+    for (int i = 0; i < total; ++i) {
+        QSizeF originalSize = m_originalPageSizes[i];
         double aspectRatio = (double)originalSize.height() / originalSize.width();
-        int targetHeight = qRound(targetWidth * aspectRatio);
+        int h = qRound(m_pageWidth * aspectRatio);
+        m_pageTops[i] = y;
+        m_pageHeights[i] = h;
+        y += h + PAGE_SPACING;
+    }
 
-        if (pageLabels[i]->size() != QSize(targetWidth, targetHeight)) {
-            pageLabels[i]->setFixedSize(targetWidth, targetHeight);
-            
-            if (pageLabels[i]->property("rendered_width").toInt() != targetWidth) {
-                pageLabels[i]->setProperty("is_hd", false);
-            }
+    updateScrollBars();
+}
+
+void PdfViewPort::updateScrollBars() {
+    int viewW = viewport()->width();
+    int viewH = viewport()->height();
+
+    verticalScrollBar()->setPageStep(viewH);
+    verticalScrollBar()->setRange(0, qMax(0, contentHeight() - viewH));
+    horizontalScrollBar()->setPageStep(viewW);
+    horizontalScrollBar()->setRange(0, qMax(0, contentWidth() - viewW));
+}
+
+int PdfViewPort::contentWidth() const {
+    return qMax(viewport()->width(), m_pageWidth);
+}
+
+int PdfViewPort::contentHeight() const {
+    if (m_pageTops.isEmpty()) return 0;
+    return m_pageTops.last() + m_pageHeights.last() + PAGE_SPACING;
+}
+
+int PdfViewPort::pageAt(int y) const {
+    if (m_pageTops.isEmpty()) return -1;
+    auto it = std::upper_bound(m_pageTops.constBegin(), m_pageTops.constEnd(), y);
+    int idx = int(it - m_pageTops.constBegin()) - 1;
+    return qBound(0, idx, m_pageTops.size() - 1);
+}
+
+QRect PdfViewPort::pageRect(int page) const {
+    int x = (contentWidth() - m_pageWidth) / 2;
+    return QRect(x, m_pageTops[page], m_pageWidth, m_pageHeights[page]);
+}
+
+void PdfViewPort::layoutVisibleWidgets() {
+    if (m_pageTops.isEmpty()) {
+        releaseAllWidgets();
+        return;
+    }
+
+    int scrollX = horizontalScrollBar()->value();
+    int scrollY = verticalScrollBar()->value();
+    QRect visible(scrollX, scrollY, viewport()->width(), viewport()->height());
+    int first = pageAt(visible.top());
+    int last = pageAt(visible.bottom());
+
+    for (auto it = m_pageWidgets.begin(); it != m_pageWidgets.end(); ) {
+        if (it.key() < first || it.key() > last || !pageRect(it.key()).intersects(visible)) {
+            PageWidget *pw = it.value();
+            pw->hide();
+            pw->clearImage();
+            pw->clearTiles();
+            pw->clearHighlights();
+            m_freeWidgets.append(pw);
+            it = m_pageWidgets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (int i = first; i <= last; ++i) {
+        QRect g = pageRect(i);
+        if (!g.intersects(visible)) continue;
+
+        PageWidget *pw = m_pageWidgets.value(i, nullptr);
+        if (!pw) {
+            pw = m_freeWidgets.isEmpty() ? new PageWidget(m_pageCache, viewport()) : m_freeWidgets.takeLast();
+            m_pageWidgets.insert(i, pw);
+            applyHighlights(i, pw);
         }
+        pw->setGeometry(g.translated(-scrollX, -scrollY));
+        pw->show();
+    }
+}
+
+void PdfViewPort::releaseAllWidgets() {
+    for (PageWidget *pw : m_pageWidgets) {
+        pw->hide();
+        pw->clearImage();
+        pw->clearTiles();
+        pw->clearHighlights();
+        m_freeWidgets.append(pw);
     }
+    m_pageWidgets.clear();
 }
 
 void PdfViewPort::updateVisiblePages(bool allowHD) {
-    if (pageLabels.isEmpty() || !m_doc) return;
+    if (m_pageTops.isEmpty() || !m_doc || !m_pageCache) return;
+    QElapsedTimer updateTimer;
+    updateTimer.start();
 
     int scrollY = verticalScrollBar()->value();
     int viewportH = viewport()->height();
     double dpr = this->devicePixelRatioF();
     
-    int buffer = viewportH * 1.0; 
-    QRect renderZone(0, scrollY - buffer, viewport()->width(), viewportH + (buffer * 2));
-
-    for (int i = 0; i < pageLabels.size(); ++i) {
-        PageWidget *pw = pageLabels[i];
-        QRect pageRect = pw->geometry();
-
-         if (pageRect.intersects(renderZone)) {
-            QSize originalSize = m_originalPageSizes[i];
-            double zoomFactor = double(pw->width()) / originalSize.width();
-            double requiredDpi = 72.0 * zoomFactor * dpr;
-            if (requiredDpi > MAX_DPI) requiredDpi = MAX_DPI;
-            
-            bool isHD = pw->property("is_hd").toBool();
-            int renderedW = pw->property("rendered_width").toInt();
-            int currentW = pw->width();
-
-            bool needRender = false;
-            int quality = QualityDraft;
-
-            if (!pw->hasImage() || renderedW != currentW) {
-                needRender = true;
-                quality = allowHD ? QualityHD : QualityDraft;
-            } 
-            else {
-                if (allowHD && !isHD) {
-                    if (requiredDpi > (DRAFT_DPI + 15.0)) {
-                        needRender = true;
-                        quality = QualityHD;
-                    }
+    // Зона рендера смещается по направлению прокрутки: впереди запас растёт
+    // со скоростью, позади остаётся полэкрана и только черновое качество.
+    double velocity = scrollVelocity();
+    bool moving = qAbs(velocity) > VELOCITY_MIN;
+    int ahead = viewportH;
+    int behind = viewportH;
+    if (moving) {
+        ahead += qMin(int(qAbs(velocity) * PREFETCH_LOOKAHEAD_MS), viewportH * 3);
+        behind = viewportH / 2;
+    }
+    int above = velocity < 0 ? ahead : behind;
+    int below = velocity < 0 ? behind : ahead;
+    QRect renderZone(horizontalScrollBar()->value(), scrollY - above, viewport()->width(), viewportH + above + below);
+    int readingLineY = scrollY + (viewportH * 0.2);
+
+    QList<RenderJob> jobs;
+    int firstPage = pageAt(renderZone.top());
+    int lastPage = pageAt(renderZone.bottom());
+    if (m_prewarmPage < firstPage || m_prewarmPage > lastPage) m_prewarmPage = -1;
+
+    for (int i = firstPage; i <= lastPage; ++i) {
+        QRect g = pageRect(i);
+        if (!g.intersects(renderZone)) continue;
+
+        PageWidget *pw = m_pageWidgets.value(i, nullptr);
+        int currentW = g.width();
+        bool behindView = moving && (velocity > 0 ? g.bottom() < scrollY : g.top() > scrollY + viewportH);
+        bool pageAllowHD = (allowHD || i == m_prewarmPage) && !behindView;
+
+        QSizeF originalSize = m_originalPageSizes[i];
+        double zoomFactor = double(currentW) / originalSize.width();
+        double requiredDpi = 72.0 * zoomFactor * dpr;
+        if (requiredDpi > MAX_DPI) requiredDpi = MAX_DPI;
+
+        QSize hdImageSize(qCeil(originalSize.width() * requiredDpi / 72.0),
+                          qCeil(originalSize.height() * requiredDpi / 72.0));
+        bool tiled = qint64(hdImageSize.width()) * hdImageSize.height() > TILE_MODE_MIN_PIXELS;
+
+        PageCacheKey hdKey = cacheKey(i, currentW, QualityHD);
+        PageCacheKey draftKey = cacheKey(i, currentW, QualityDraft);
+        PageCacheKey shown;
+        if (pw) {
+            if (pw->hasImage()) shown = pw->imageKey();
+        } else if (m_pageCache->contains(hdKey)) {
+            shown = hdKey;
+        } else if (m_pageCache->contains(draftKey)) {
+            shown = draftKey;
+        }
+        bool hasAny = shown.isValid();
+        bool showsCurrent = hasAny && shown.width == currentW && shown.profile == hdKey.profile;
+        bool showsHD = showsCurrent && shown.quality == QualityHD;
+
+        if (!renderQueue->isInFlight(RenderJob::idFor(i))) {
+            bool wantHD = pageAllowHD && !tiled && requiredDpi > (DRAFT_DPI + 15.0);
+
+            if (pw && !tiled && !showsHD && (wantHD || !showsCurrent)) {
+                if (m_pageCache->lookup(hdKey)) {
+                    pw->setImage(hdKey);
+                    hasAny = showsCurrent = showsHD = true;
+                }
+            }
+            if (pw && !hasAny) {
+                if (m_pageCache->lookup(draftKey)) {
+                    pw->setImage(draftKey);
+                    hasAny = showsCurrent = true;
                 }
             }
 
-            if (needRender) {
-                requestPageRender(i, quality);
+            if (!showsCurrent) {
+                if (!hasAny) {
+                    if (pw) pw->setLoading();
+                    jobs.append(pageJob(i, (pageAllowHD && !tiled) ? QualityHD : QualityDraft, readingLineY));
+                } else if (pageAllowHD) {
+                    jobs.append(pageJob(i, tiled ? QualityDraft : QualityHD, readingLineY));
+                }
+            } else if (wantHD && !showsHD) {
+                jobs.append(pageJob(i, QualityHD, readingLineY));
             }
+        }
 
-        } else {
-            if (qAbs(pageRect.top() - scrollY) > viewportH * 3) {
-                if (!pw->isLoading() && pw->hasImage()) {
-                    pw->clearPixmap();
-                    pw->setProperty("rendered_width", -1);
-                    pw->setProperty("is_hd", false);
+        if (!tiled) {
+            if (pw && showsHD) pw->clearTiles();
+        } else if (pageAllowHD) {
+            if (pw) pw->setTileLayout(hdImageSize);
+
+            double scale = double(hdImageSize.width()) / currentW;
+            QRect zoneInPage = renderZone.intersected(g).translated(-g.topLeft());
+            QRect zoneInImage(qFloor(zoneInPage.x() * scale), qFloor(zoneInPage.y() * scale),
+                              qCeil(zoneInPage.width() * scale), qCeil(zoneInPage.height() * scale));
+            zoneInImage = zoneInImage.intersected(QRect(QPoint(0, 0), hdImageSize));
+            if (pw) pw->dropTilesOutside(zoneInImage);
+
+            int cols = (hdImageSize.width() + TILE_SIZE - 1) / TILE_SIZE;
+            int firstCol = zoneInImage.left() / TILE_SIZE;
+            int lastCol = zoneInImage.right() / TILE_SIZE;
+            int firstRow = zoneInImage.top() / TILE_SIZE;
+            int lastRow = zoneInImage.bottom() / TILE_SIZE;
+
+            for (int row = firstRow; row <= lastRow; ++row) {
+                for (int col = firstCol; col <= lastCol; ++col) {
+                    int tileIndex = row * cols + col;
+                    if (renderQueue->isInFlight(RenderJob::idFor(i, tileIndex))) continue;
+
+                    QRect tileRect = QRect(col * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE)
+                                         .intersected(QRect(QPoint(0, 0), hdImageSize));
+                    PageCacheKey tileKey = cacheKey(i, currentW, QualityHD, tileIndex);
+                    if (pw ? pw->hasTile(tileIndex) : m_pageCache->contains(tileKey)) continue;
+
+                    if (pw && m_pageCache->lookup(tileKey)) {
+                        pw->setTile(tileIndex, tileRect, tileKey);
+                    } else {
+                        RenderJob job = pageJob(i, QualityHD, readingLineY);
+                        job.tile = tileIndex;
+                        job.tileRect = tileRect;
+                        job.imageSize = hdImageSize;
+                        job.dpi = requiredDpi;
+                        job.cacheKey = tileKey;
+                        int tileCenterY = g.top() + qRound((tileRect.center().y() + 0.5) / scale);
+                        job.distance = qAbs(tileCenterY - readingLineY);
+                        jobs.append(job);
+                    }
                 }
             }
         }
     }
-}
 
-void PdfViewPort::requestPageRender(int i, int quality) {
-if (activeRenders.contains(i)) return;
+    renderQueue->schedule(jobs, firstPage, lastPage);
 
-    PageWidget *lbl = pageLabels[i];
-    if (!lbl->hasImage()) {
-        lbl->setLoading();
+    double elapsed = updateTimer.nsecsElapsed() / 1e6;
+    m_updateMs = m_updateMs == 0.0 ? elapsed : m_updateMs * 0.8 + elapsed * 0.2;
+}
+
+RenderJob PdfViewPort::pageJob(int page, int quality, int readingLineY) const {
+    QRect g = pageRect(page);
+
+    RenderJob job;
+    job.page = page;
+    job.quality = quality;
+    job.targetSize = g.size();
+    job.dpr = this->devicePixelRatioF();
+    job.cacheKey = cacheKey(page, g.width(), quality);
+    if (readingLineY < g.top()) {
+        job.distance = g.top() - readingLineY;
+    } else if (readingLineY > g.bottom()) {
+        job.distance = readingLineY - g.bottom();
     }
-    
-    QSize tSize = lbl->size(); 
-    if (tSize.width() <= 0) return;
+    double velocity = scrollVelocity();
+    if ((velocity > VELOCITY_MIN && g.bottom() < readingLineY) || (velocity < -VELOCITY_MIN && g.top() > readingLineY)) {
+        job.distance *= 2;
+    }
+    return job;
+}
 
-    double dpr = this->devicePixelRatioF();
-    QString docPath = m_docPath; 
-    QString sText = m_currentSearchText;
-    QRectF sRect = m_currentSearchRect;
-
-    QFutureWatcher<QImage> *watcher = new QFutureWatcher<QImage>();
-    activeRenders.insert(i, watcher);
-
-    connect(watcher, &QFutureWatcher<QImage>::finished, [this, i, watcher, lbl, dpr, tSize, quality](){
-        if (activeRenders.value(i) == watcher) {
-            QImage result = watcher->result();
-            
-            if (!result.isNull()) {
-                result.setDevicePixelRatio(dpr); 
-                lbl->setPixmap(QPixmap::fromImage(result));
-                lbl->setProperty("is_hd", (quality == QualityHD));
-                lbl->setProperty("rendered_width", tSize.width());
+void PdfViewPort::onRenderFinished(const RenderJob &job, const QImage &image) {
+    if (job.page >= 0 && job.page < totalPages() && !image.isNull() && m_pageCache) {
+        PageWidget *pw = m_pageWidgets.value(job.page, nullptr);
+        if (job.tile >= 0) {
+            m_pageCache->insert(job.cacheKey, QPixmap::fromImage(image, Qt::NoFormatConversion));
+            if (pw && pw->tileImageSize() == job.imageSize) {
+                pw->setTile(job.tile, job.tileRect, job.cacheKey);
             }
-            activeRenders.remove(i);
-            QTimer::singleShot(0, [this](){ 
-                if (!renderTimer->isActive()) {
-                    updateVisiblePages(true);
-                }
-            });
+        } else {
+            QImage result = image;
+            result.setDevicePixelRatio(job.dpr);
+            m_pageCache->insert(job.cacheKey, QPixmap::fromImage(std::move(result), Qt::NoFormatConversion));
+            if (pw) pw->setImage(job.cacheKey);
+            if (job.page == m_prewarmPage && job.quality == QualityHD) m_prewarmPage = -1;
         }
-        watcher->deleteLater();
-    });
+    }
 
-    watcher->setFuture(QtConcurrent::run([i, tSize, sText, sRect, dpr, docPath, quality]() {
-        QImage img;
-        if (docPath.isEmpty()) return img;
+    if (job.traceId) {
+        Tracer::asyncEnd("page job", "render", job.traceId, Tracer::args(QJsonObject{{"canceled", image.isNull()}}));
+    }
 
-        if (quality == QualityDraft) {
-            QThread::currentThread()->setPriority(QThread::HighestPriority);
-        } else {
-            QThread::currentThread()->setPriority(QThread::NormalPriority);
+    QTimer::singleShot(0, this, [this](){
+        if (!renderTimer->isActive()) {
+            updateVisiblePages(true);
         }
+    });
+}
 
-        Poppler::Document *threadDoc = Poppler::Document::load(docPath);
-        if (!threadDoc) return img;
+PageCacheKey PdfViewPort::cacheKey(int page, int width, int quality, int tile) const {
+    PageCacheKey key;
+    key.file = m_docPool ? m_docPool->filePath() : QString();
+    key.page = page;
+    key.width = width;
+    key.height = page < m_pageHeights.size() ? m_pageHeights[page] : 0;
+    key.quality = quality;
+    key.tile = tile;
+    key.profile = m_docPool ? m_docPool->profileSerial() : 0;
+    return key;
+}
 
-        threadDoc->setRenderHint(Poppler::Document::TextAntialiasing, true);
-        threadDoc->setRenderHint(Poppler::Document::Antialiasing, true);
+int PdfViewPort::currentPage() const {
+    if (m_pageTops.isEmpty()) return 0;
 
-        if (i < threadDoc->numPages()) {
-            Poppler::Page *p = threadDoc->page(i);
-            if (p) {
-                double dpi;
-                
-                if (quality == QualityDraft) {
-                    dpi = DRAFT_DPI * dpr; 
-                } else {
-                    QSizeF pdfSize = p->pageSizeF();
-                    double zoomFactor = double(tSize.width()) / pdfSize.width();
-                    dpi = 72.0 * zoomFactor * dpr;
-                    if (dpi > MAX_DPI) dpi = MAX_DPI; 
-                }
-                
-                img = p->renderToImage(dpi, dpi);
-
-                if (!img.isNull() && !sText.isEmpty()) {
-                    QList<QRectF> res = p->search(sText, Poppler::Page::IgnoreCase);
-                    if (!res.isEmpty()) {
-                        QPainter painter(&img);
-                        painter.setCompositionMode(QPainter::CompositionMode_Multiply);
-                        double sx = double(img.width()) / p->pageSizeF().width();
-                        double sy = double(img.height()) / p->pageSizeF().height();
-                        for (const QRectF &r : res) {
-                            bool active = qAbs(r.x() - sRect.x()) < 0.001;
-                            painter.setBrush(active ? QColor(255, 140, 0) : QColor(255, 235, 60));
-                            painter.setPen(Qt::NoPen);
-                            painter.drawRect(QRectF(r.x()*sx, r.y()*sy, r.width()*sx, r.height()*sy).adjusted(-2,-2,2,2));
-                        }
-                    }
-                }
-                delete p;
-            }
+    QScrollBar *bar = verticalScrollBar();
+    int value = bar->value();
+    if (value <= 15) return 1;
+    if (value >= bar->maximum() - 15) return totalPages();
+    int readingLineY = value + (viewport()->height() * 0.2);
+    return pageAt(readingLineY) + 1;
+}
+
+// Что сейчас видит пользователь на каждой странице в окне: пустое место,
+// черновик (или картинка от прежнего масштаба) либо резкое изображение.
+QMap<int, PdfViewPort::PageState> PdfViewPort::visiblePageStates() const {
+    QMap<int, PageState> states;
+    if (m_pageTops.isEmpty()) return states;
+
+    int scrollY = verticalScrollBar()->value();
+    QRect visible(0, scrollY, contentWidth(), viewport()->height());
+    int last = pageAt(visible.bottom());
+    for (int i = pageAt(scrollY); i <= last; ++i) {
+        if (!pageRect(i).intersects(visible)) continue;
+        PageWidget *pw = m_pageWidgets.value(i, nullptr);
+        PageState state = PageBlank;
+        if (pw && pw->hasImage()) {
+            PageCacheKey key = pw->imageKey();
+            bool current = key.width == m_pageWidth;
+            if (current && (key.quality == QualityHD || pw->hasTiles())) state = PageSharp;
+            else state = PageDraft;
         }
-        delete threadDoc;
-        return img;
-    }));
+        states.insert(i, state);
+    }
+    return states;
+}
+
+PdfViewPort::Stats PdfViewPort::stats() const {
+    Stats st;
+    st.queuedJobs = renderQueue->pendingCount();
+    st.inFlightJobs = renderQueue->inFlightCount();
+    st.finishedJobs = renderQueue->finishedCount();
+    st.canceledJobs = renderQueue->canceledCount();
+    st.draftRenderMs = renderQueue->averageRenderMs(QualityDraft);
+    st.hdRenderMs = renderQueue->averageRenderMs(QualityHD);
+    if (m_pageCache) {
+        PageCache::Stats cs = m_pageCache->stats();
+        quint64 lookups = cs.hits + cs.misses;
+        st.cacheHitRate = lookups > 0 ? double(cs.hits) / lookups : 0.0;
+        st.pixmapBytes = cs.usedBytes;
+        st.pixmapBudget = cs.budgetBytes;
+    }
+    st.pageWidgets = m_pageWidgets.size();
+    st.updateMs = m_updateMs;
+    st.frameMs = m_frameMs;
+    st.worstFrameMs = m_worstFrameMs;
+    return st;
+}
+
+// Оверлей со счётчиками. Пока он виден, таймер с периодом кадра меряет,
+// насколько GUI-поток опаздывает с обработкой событий.
+void PdfViewPort::setHudVisible(bool visible) {
+    if (!m_hud) {
+        m_hud = new QLabel(this);
+        m_hud->setAttribute(Qt::WA_TransparentForMouseEvents);
+        m_hud->setStyleSheet("QLabel { background: rgba(0, 0, 0, 170); color: #9f9; padding: 6px;"
+                             " font-family: monospace; font-size: 11px; border-radius: 4px; }");
+        m_hud->move(8, 8);
+
+        m_hudTimer = new QTimer(this);
+        m_hudTimer->setInterval(250);
+        connect(m_hudTimer, &QTimer::timeout, this, &PdfViewPort::refreshHud);
+
+        m_frameTimer = new QTimer(this);
+        m_frameTimer->setTimerType(Qt::PreciseTimer);
+        m_frameTimer->setInterval(16);
+        connect(m_frameTimer, &QTimer::timeout, this, &PdfViewPort::onFrameTick);
+    }
+
+    m_hud->setVisible(visible);
+    if (visible) {
+        m_frameClock.start();
+        m_worstFrameWindowMs = 0.0;
+        m_hudTimer->start();
+        m_frameTimer->start();
+        refreshHud();
+        m_hud->raise();
+    } else {
+        m_hudTimer->stop();
+        m_frameTimer->stop();
+        m_frameMs = 0.0;
+        m_worstFrameMs = 0.0;
+    }
+}
+
+void PdfViewPort::onFrameTick() {
+    double interval = m_frameClock.nsecsElapsed() / 1e6;
+    m_frameClock.restart();
+    m_frameMs = m_frameMs == 0.0 ? interval : m_frameMs * 0.9 + interval * 0.1;
+    m_worstFrameWindowMs = qMax(m_worstFrameWindowMs, interval);
+}
+
+void PdfViewPort::refreshHud() {
+    m_worstFrameMs = m_worstFrameWindowMs;
+    m_worstFrameWindowMs = 0.0;
+
+    Stats st = stats();
+    QString text = QString("queue %1   in flight %2\n"
+                           "draft %3 ms   hd %4 ms\n"
+                           "done %5   canceled %6\n"
+                           "cache hit %7%   %8 / %9 MB\n"
+                           "widgets %10   update %11 ms\n"
+                           "frame %12 ms   worst %13 ms")
+        .arg(st.queuedJobs).arg(st.inFlightJobs)
+        .arg(st.draftRenderMs, 0, 'f', 1).arg(st.hdRenderMs, 0, 'f', 1)
+        .arg(st.finishedJobs).arg(st.canceledJobs)
+        .arg(st.cacheHitRate * 100.0, 0, 'f', 1)
+        .arg(st.pixmapBytes / (1024 * 1024)).arg(st.pixmapBudget / (1024 * 1024))
+        .arg(st.pageWidgets).arg(st.updateMs, 0, 'f', 2)
+        .arg(st.frameMs, 0, 'f', 1).arg(st.worstFrameMs, 0, 'f', 1);
+    m_hud->setText(text);
+    m_hud->adjustSize();
+    m_hud->raise();
 }
 
 void PdfViewPort::goToPage(int page, double yOffsetFraction) {
-    if (page < 1 || page > pageLabels.size()) return;
-    int y = pageLabels[page-1]->y() + (pageLabels[page-1]->height() * yOffsetFraction);
+    if (page < 1 || page > m_pageTops.size()) return;
+    int y = m_pageTops[page-1] + (m_pageHeights[page-1] * yOffsetFraction);
+    m_prewarmPage = page - 1;
+    m_ignoreScrollDelta = true;
     verticalScrollBar()->setValue(y);
+    m_ignoreScrollDelta = false;
+    updateVisiblePages(false);
 }
 
-void PdfViewPort::updateHighlight(const QString &text, QRectF rect) {
-    m_currentSearchText = text;
-    m_currentSearchRect = rect;
-    for (auto *p : pageLabels) {
-        p->setProperty("rendered_width", -1);
+void PdfViewPort::keyPressEvent(QKeyEvent *event) {
+    if (!m_pageTops.isEmpty() && (event->key() == Qt::Key_PageDown || event->key() == Qt::Key_PageUp)) {
+        QScrollBar *bar = verticalScrollBar();
+        int step = event->key() == Qt::Key_PageDown ? bar->pageStep() : -bar->pageStep();
+        int target = qBound(0, bar->value() + step, bar->maximum());
+        m_prewarmPage = pageAt(target + int(viewport()->height() * 0.2));
     }
-    updateVisiblePages(true);
+    QAbstractScrollArea::keyPressEvent(event);
+}
+
+void PdfViewPort::trackScrollVelocity(int value) {
+    int delta = value - m_lastScrollValue;
+    m_lastScrollValue = value;
+    if (m_ignoreScrollDelta || !m_scrollClock.isValid()) {
+        m_scrollVelocity = 0.0;
+        m_scrollClock.start();
+        return;
+    }
+    qint64 dt = qMax<qint64>(1, m_scrollClock.restart());
+    if (dt > VELOCITY_IDLE_MS) m_scrollVelocity = 0.0;
+    m_scrollVelocity = m_scrollVelocity * 0.6 + (double(delta) / dt) * 0.4;
+}
+
+double PdfViewPort::scrollVelocity() const {
+    if (!m_scrollClock.isValid() || m_scrollClock.elapsed() > VELOCITY_IDLE_MS) return 0.0;
+    return m_scrollVelocity;
+}
+
+void PdfViewPort::setSearchResults(const QList<QPair<int, QRectF>> &results) {
+    m_searchHits.clear();
+    for (const auto &hit : results) {
+        m_searchHits[hit.first].append(hit.second);
+    }
+    for (auto it = m_pageWidgets.constBegin(); it != m_pageWidgets.constEnd(); ++it) {
+        applyHighlights(it.key(), it.value());
+    }
+}
+
+void PdfViewPort::updateHighlight(int page, QRectF rect) {
+    int oldPage = m_activeHitPage;
+    m_activeHitPage = page;
+    m_activeHitRect = rect;
+
+    PageWidget *pw = m_pageWidgets.value(oldPage, nullptr);
+    if (pw) applyHighlights(oldPage, pw);
+    pw = m_pageWidgets.value(page, nullptr);
+    if (pw) applyHighlights(page, pw);
 }
 
 void PdfViewPort::clearSearch() {
-    m_currentSearchText = "";
-    for (auto *p : pageLabels) {
-        p->setProperty("rendered_width", -1);
+    m_searchHits.clear();
+    m_activeHitPage = -1;
+    m_activeHitRect = QRectF();
+    for (PageWidget *pw : m_pageWidgets) {
+        pw->clearHighlights();
     }
-    updateVisiblePages(true);
 }
 
-void PdfViewPort::clearLayout() {
-    pageLabels.clear();
-    QLayoutItem *child;
-    while ((child = scrollLayout->takeAt(0)) != nullptr) {
-        if (child->widget()) child->widget()->deleteLater();
-        delete child;
+void PdfViewPort::applyHighlights(int page, PageWidget *pw) {
+    auto it = m_searchHits.constFind(page);
+    if (it == m_searchHits.constEnd()) {
+        pw->clearHighlights();
+        return;
     }
+    QRectF active = (page == m_activeHitPage) ? m_activeHitRect : QRectF();
+    pw->setHighlights(m_originalPageSizes[page], it.value(), active);
 }
 
 void PdfViewPort::wheelEvent(QWheelEvent *event) {
@@ -403,13 +755,15 @@ void PdfViewPort::wheelEvent(QWheelEvent *event) {
         emit zoomRequested(event->angleDelta().y() > 0);
         event->accept(); 
     } else {
-        QScrollArea::wheelEvent(event);
+        QAbstractScrollArea::wheelEvent(event);
     }
 }
 
 bool PdfViewPort::viewportEvent(QEvent *event) {
     if (event->type() == QEvent::MouseButtonPress || event->type() == QEvent::TouchBegin) {
         emit interacted();
+    } else if (event->type() == QEvent::Resize && !zoomTimer->isActive()) {
+        zoomTimer->start();
     }
-    return QScrollArea::viewportEvent(event);
-}
\ No newline at end of file
+    return QAbstractScrollArea::viewportEvent(event);
+}
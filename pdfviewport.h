@@ -1,4 +1,3 @@
-    
 /*
  * PDF Reader
  * Copyright (c) 2026 [Muzon4ik]
@@ -11,34 +10,72 @@
 #ifndef PDFVIEWPORT_H
 #define PDFVIEWPORT_H
 
-#include <QScrollArea>
-#include <QVBoxLayout>
+#include <QAbstractScrollArea>
 #include <QScrollBar>
 #include <QMutex>
 #include <QTimer>
+#include <QLabel>
+#include <QHash>
 #include <QMap>
+#include <QVector>
 #include <QFutureWatcher>
 #include <poppler-qt5.h>
 #include <QThread>
+#include <QElapsedTimer>
+#include <QSharedPointer>
 #include "custom_widgets.h"
+#include "documentpool.h"
+#include "pagecache.h"
+#include "renderqueue.h"
 
-class PdfViewPort : public QScrollArea {
+class PdfViewPort : public QAbstractScrollArea {
     Q_OBJECT
 public:
+    enum PageState {
+        PageBlank,
+        PageDraft,
+        PageSharp
+    };
+
+    struct Stats {
+        int queuedJobs = 0;
+        int inFlightJobs = 0;
+        quint64 finishedJobs = 0;
+        quint64 canceledJobs = 0;
+        double draftRenderMs = 0.0;
+        double hdRenderMs = 0.0;
+        double cacheHitRate = 0.0;
+        qint64 pixmapBytes = 0;
+        qint64 pixmapBudget = 0;
+        int pageWidgets = 0;
+        double updateMs = 0.0;
+        double frameMs = 0.0;
+        double worstFrameMs = 0.0;
+    };
+
     explicit PdfViewPort(QWidget *parent = nullptr);
     ~PdfViewPort();
 
     void setDocument(Poppler::Document *doc, QMutex *mutex);
-    void setFilePath(const QString &path);
+    void setDocumentPool(const QSharedPointer<DocumentPool> &pool);
+    void setPageCache(PageCache *cache);
+    void setDiskCache(DiskCache *cache);
     void setZoom(double zoom);
-    
+
     double getZoom() const { return m_currentZoom; }
 
     void goToPage(int page, double yOffsetFraction = 0.0);
-    void updateHighlight(const QString &text, QRectF rect);
+    int currentPage() const;
+    QMap<int, PageState> visiblePageStates() const;
+    void setSearchResults(const QList<QPair<int, QRectF>> &results);
+    void updateHighlight(int page, QRectF rect);
     void clearSearch();
     void stopAllRenders();
-    int totalPages() const { return pageLabels.size(); }
+
+    Stats stats() const;
+    void setHudVisible(bool visible);
+    bool isHudVisible() const { return m_hud && m_hud->isVisible(); }
+    int totalPages() const { return m_originalPageSizes.size(); }
 
 signals:
     void pageInViewChanged(int page);
@@ -50,37 +87,78 @@ protected:
     void wheelEvent(QWheelEvent *event) override;
     void showEvent(QShowEvent *event) override;
     bool viewportEvent(QEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void keyPressEvent(QKeyEvent *event) override;
 
 private slots:
     void onRenderTimeout();
     void onScrollValueChanged(int value);
+    void onRenderFinished(const RenderJob &job, const QImage &image);
+    void onPageSizesReady(int batch);
+    void onFrameTick();
+    void refreshHud();
 
 private:
     void updateVisiblePages(bool allowHD);
-    void requestPageRender(int index, int quality);
-    
+    RenderJob pageJob(int page, int quality, int readingLineY) const;
+    PageCacheKey cacheKey(int page, int width, int quality, int tile = -1) const;
+    void applyHighlights(int page, PageWidget *pw);
+    void trackScrollVelocity(int value);
+    double scrollVelocity() const;
+
     void performZoomOrResize();
-    void updateGridHelper();
-    void clearLayout();
+    void relayoutKeepingAnchor();
+    void startPageSizeDiscovery(int total);
+    void rebuildLayout();
+    void updateScrollBars();
+    void layoutVisibleWidgets();
+    void releaseAllWidgets();
     void cancelAllRenders();
 
+    int pageAt(int y) const;
+    QRect pageRect(int page) const;
+    int contentWidth() const;
+    int contentHeight() const;
+
     Poppler::Document *m_doc = nullptr;
     QMutex *m_docMutex = nullptr;
-    
-    QWidget *scrollContainer;
-    QVBoxLayout *scrollLayout;
-    QList<PageWidget*> pageLabels;
-    QList<QSize> m_originalPageSizes;
-    
-    double m_currentZoom = 1.0; 
-    QString m_docPath;
-    QString m_currentSearchText;
-    QRectF m_currentSearchRect;
-    
+
+    QVector<QSizeF> m_originalPageSizes;
+    QVector<int> m_pageTops;
+    QVector<int> m_pageHeights;
+    int m_pageWidth = 0;
+
+    QHash<int, PageWidget*> m_pageWidgets;
+    QList<PageWidget*> m_freeWidgets;
+
+    double m_currentZoom = 1.0;
+    QSharedPointer<DocumentPool> m_docPool;
+    PageCache *m_pageCache = nullptr;
+    QHash<int, QList<QRectF>> m_searchHits;
+    int m_activeHitPage = -1;
+    QRectF m_activeHitRect;
+
     QTimer *renderTimer;
-    QMap<int, QFutureWatcher<QImage>*> activeRenders;
+    QTimer *zoomTimer;
+    RenderQueue *renderQueue;
+    QFutureWatcher<QVector<QSizeF>> *m_sizeWatcher;
 
     double m_accumulatedZoomDelta = 0;
+
+    QElapsedTimer m_scrollClock;
+    int m_lastScrollValue = 0;
+    double m_scrollVelocity = 0.0;
+    bool m_ignoreScrollDelta = false;
+    int m_prewarmPage = -1;
+
+    QLabel *m_hud = nullptr;
+    QTimer *m_hudTimer = nullptr;
+    QTimer *m_frameTimer = nullptr;
+    QElapsedTimer m_frameClock;
+    double m_frameMs = 0.0;
+    double m_worstFrameMs = 0.0;
+    double m_worstFrameWindowMs = 0.0;
+    double m_updateMs = 0.0;
 };
 
-#endif // PDFVIEWPORT_H
\ No newline at end of file
+#endif // PDFVIEWPORT_H
@@ -0,0 +1,142 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //renderprofile.cpp
+#include "renderprofile.h"
+#include "documentpool.h"
+#include <QElapsedTimer>
+#include <QImage>
+#include <QVector>
+#include <QtConcurrent>
+
+const double CALIBRATION_DPI = 110.0;
+const int COMPARE_WIDTH = 256;
+// Допустимое среднее отличие от эталона (0..255) для HD и чернового профиля.
+const double HD_MAX_DIFF = 4.0;
+const double DRAFT_MAX_DIFF = 12.0;
+// Другой движок выбирается, только если он заметно быстрее.
+const double MIN_SPEEDUP = 0.85;
+
+void RenderProfile::applyTo(Poppler::Document *doc) const {
+    if (!doc) return;
+    doc->setRenderBackend(backend);
+    doc->setRenderHint(Poppler::Document::Antialiasing, hints.testFlag(Poppler::Document::Antialiasing));
+    doc->setRenderHint(Poppler::Document::TextAntialiasing, hints.testFlag(Poppler::Document::TextAntialiasing));
+    doc->setRenderHint(Poppler::Document::TextHinting, hints.testFlag(Poppler::Document::TextHinting));
+    doc->setRenderHint(Poppler::Document::ThinLineSolid, hints.testFlag(Poppler::Document::ThinLineSolid));
+}
+
+RenderProfile RenderProfile::defaultFor(RenderProfileId id) {
+    RenderProfile p;
+    switch (id) {
+    case ProfileDraft:
+        // Черновик живёт доли секунды: без сглаживания векторной графики,
+        // тонкие линии чертежей рисуются сплошными, чтобы не пропадали.
+        p.name = "draft";
+        p.hints = Poppler::Document::TextAntialiasing | Poppler::Document::ThinLineSolid;
+        break;
+    case ProfileThumbnail:
+        p.name = "thumbnail";
+        p.hints = Poppler::Document::Antialiasing | Poppler::Document::ThinLineSolid;
+        break;
+    case ProfileHD:
+    default:
+        p.name = "hd";
+        p.hints = Poppler::Document::Antialiasing | Poppler::Document::TextAntialiasing;
+        break;
+    }
+    return p;
+}
+
+static QImage comparable(const QImage &img) {
+    return img.scaledToWidth(COMPARE_WIDTH, Qt::SmoothTransformation).convertToFormat(QImage::Format_Grayscale8);
+}
+
+static double meanDifference(const QImage &a, const QImage &b) {
+    if (a.size() != b.size() || a.isNull()) return 255.0;
+    qint64 sum = 0;
+    for (int y = 0; y < a.height(); ++y) {
+        const uchar *la = a.constScanLine(y);
+        const uchar *lb = b.constScanLine(y);
+        for (int x = 0; x < a.width(); ++x) sum += qAbs(int(la[x]) - int(lb[x]));
+    }
+    return double(sum) / (qint64(a.width()) * a.height());
+}
+
+struct CalibrationRun {
+    qint64 elapsedMs = 0;
+    QVector<QImage> images;
+};
+
+static CalibrationRun timeProfile(Poppler::Document *doc, const RenderProfile &profile, int pages) {
+    CalibrationRun run;
+    profile.applyTo(doc);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < pages; ++i) {
+        Poppler::Page *p = doc->page(i);
+        QImage img = p ? p->renderToImage(CALIBRATION_DPI, CALIBRATION_DPI) : QImage();
+        delete p;
+        run.images.append(img);
+    }
+    run.elapsedMs = timer.elapsed();
+    for (QImage &img : run.images) {
+        if (!img.isNull()) img = comparable(img);
+    }
+    return run;
+}
+
+void RenderCalibrator::start(const QSharedPointer<DocumentPool> &pool) {
+    if (!pool) return;
+    QtConcurrent::run([pool]() {
+        RenderCalibrator::calibrate(pool.data());
+    });
+}
+
+// Калибровка идёт на документе пула для текущего потока, а не на отдельной
+// копии: прогоны по очереди меняют ему профиль, а в конце возвращается
+// HD-профиль, под которым пул его и числит.
+void RenderCalibrator::calibrate(DocumentPool *pool) {
+    Poppler::Document *doc = pool->acquire(ProfileHD);
+    if (!doc) return;
+    int pages = qMin(SamplePages, doc->numPages());
+    if (pages <= 0) return;
+
+    const RenderProfileId ids[] = { ProfileHD, ProfileDraft };
+    const double maxDiff[] = { HD_MAX_DIFF, DRAFT_MAX_DIFF };
+    const Poppler::Document::RenderBackend backends[] = { Poppler::Document::SplashBackend, Poppler::Document::ArthurBackend };
+
+    // Эталон — HD-профиль на Splash; первый прогон также прогревает шрифты и кэши Poppler.
+    RenderProfile reference = RenderProfile::defaultFor(ProfileHD);
+    timeProfile(doc, reference, 1);
+    CalibrationRun referenceRun = timeProfile(doc, reference, pages);
+
+    for (int k = 0; k < 2; ++k) {
+        RenderProfile best = RenderProfile::defaultFor(ids[k]);
+        best.backend = Poppler::Document::SplashBackend;
+        CalibrationRun bestRun = ids[k] == ProfileHD ? referenceRun : timeProfile(doc, best, pages);
+
+        for (Poppler::Document::RenderBackend backend : backends) {
+            if (backend == best.backend) continue;
+            RenderProfile candidate = best;
+            candidate.backend = backend;
+            CalibrationRun run = timeProfile(doc, candidate, pages);
+
+            double diff = 0.0;
+            for (int i = 0; i < pages; ++i) {
+                diff = qMax(diff, meanDifference(run.images[i], referenceRun.images[i]));
+            }
+            if (diff <= maxDiff[k] && run.elapsedMs < bestRun.elapsedMs * MIN_SPEEDUP) {
+                best = candidate;
+                bestRun = run;
+            }
+        }
+        pool->setProfile(ids[k], best);
+    }
+    pool->profile(ProfileHD).applyTo(doc);
+}
@@ -0,0 +1,49 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //renderprofile.h
+#ifndef RENDERPROFILE_H
+#define RENDERPROFILE_H
+
+#include <QString>
+#include <QSharedPointer>
+#include <poppler-qt5.h>
+
+class DocumentPool;
+
+enum RenderProfileId {
+    ProfileDraft,
+    ProfileHD,
+    ProfileThumbnail,
+    ProfileCount
+};
+
+// Набор настроек Poppler для одного вида рендера.
+struct RenderProfile {
+    QString name;
+    Poppler::Document::RenderBackend backend = Poppler::Document::SplashBackend;
+    Poppler::Document::RenderHints hints;
+
+    void applyTo(Poppler::Document *doc) const;
+    bool operator==(const RenderProfile &o) const { return backend == o.backend && hints == o.hints; }
+    bool operator!=(const RenderProfile &o) const { return !(*this == o); }
+
+    static RenderProfile defaultFor(RenderProfileId id);
+};
+
+// Замеряет доступные движки на первых страницах документа и назначает пулу
+// самый быстрый из тех, чей результат почти не отличается от эталона Splash.
+class RenderCalibrator {
+public:
+    static const int SamplePages = 3;
+
+    static void start(const QSharedPointer<DocumentPool> &pool);
+    static void calibrate(DocumentPool *pool);
+};
+
+#endif // RENDERPROFILE_H
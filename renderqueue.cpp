@@ -0,0 +1,255 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //renderqueue.cpp
+#include "renderqueue.h"
+#include "tracer.h"
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include <utility>
+#if defined(__has_include)
+#if __has_include(<poppler-version.h>)
+#include <poppler-version.h>
+#endif
+#endif
+
+RenderQueue::RenderQueue(QObject *parent) : QObject(parent) {
+    m_maxInFlight = qMax(2, QThread::idealThreadCount() - 1);
+}
+
+RenderQueue::~RenderQueue() {
+    abandonAll();
+}
+
+void RenderQueue::setDocumentPool(const QSharedPointer<DocumentPool> &pool) {
+    m_docPool = pool;
+}
+
+void RenderQueue::setDiskCache(DiskCache *cache) {
+    m_diskCache = cache;
+}
+
+void RenderQueue::setMaxInFlight(int count) {
+    m_maxInFlight = qMax(1, count);
+    dispatch();
+}
+
+void RenderQueue::schedule(QList<RenderJob> jobs, int firstPage, int lastPage) {
+    for (Running &r : m_inFlight) {
+        if (r.job.page < firstPage || r.job.page > lastPage) {
+            r.canceled->store(1);
+        }
+    }
+
+    m_pending.clear();
+    for (const RenderJob &job : jobs) {
+        if (!m_inFlight.contains(job.id())) m_pending.append(job);
+    }
+
+    std::stable_sort(m_pending.begin(), m_pending.end(), [](const RenderJob &a, const RenderJob &b) {
+        if (a.quality != b.quality) return a.quality < b.quality;
+        return a.distance < b.distance;
+    });
+
+    dispatch();
+}
+
+bool RenderQueue::isInFlight(qint64 id) const {
+    return m_inFlight.contains(id);
+}
+
+void RenderQueue::cancelAll() {
+    m_pending.clear();
+    for (Running &r : m_inFlight) {
+        r.canceled->store(1);
+    }
+}
+
+// Задачи не дожидаются: они держат пул документов и свой флаг отмены
+// сами, а результат отключённого наблюдателя просто никто не заберёт.
+void RenderQueue::abandonAll() {
+    m_pending.clear();
+    for (Running &r : m_inFlight) {
+        r.canceled->store(1);
+        r.watcher->disconnect();
+        r.watcher->deleteLater();
+        if (r.job.traceId) Tracer::asyncEnd("page job", "render", r.job.traceId);
+    }
+    m_inFlight.clear();
+}
+
+void RenderQueue::dispatch() {
+    while (m_inFlight.size() < m_maxInFlight && !m_pending.isEmpty()) {
+        RenderJob job = m_pending.takeFirst();
+        if (m_inFlight.contains(job.id())) continue;
+        if (Tracer::isEnabled()) {
+            job.traceId = ++m_traceSerial;
+            Tracer::asyncBegin("page job", "render", job.traceId,
+                               Tracer::args(QJsonObject{{"page", job.page}, {"tile", job.tile}, {"quality", job.quality}}));
+        }
+
+        Running r;
+        r.job = job;
+        r.canceled = QSharedPointer<QAtomicInt>::create(0);
+        r.watcher = new QFutureWatcher<QImage>(this);
+        r.timer.start();
+
+        QFutureWatcher<QImage> *watcher = r.watcher;
+        connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher]() {
+            onWatcherFinished(watcher);
+        });
+        m_inFlight.insert(job.id(), r);
+
+        QSharedPointer<DocumentPool> pool = m_docPool;
+        QSharedPointer<QAtomicInt> canceled = r.canceled;
+        DiskCache *diskCache = m_diskCache;
+        watcher->setFuture(QtConcurrent::run([job, pool, canceled, diskCache]() {
+            return RenderQueue::render(job, pool.data(), canceled.data(), diskCache);
+        }));
+    }
+}
+
+void RenderQueue::onWatcherFinished(QFutureWatcher<QImage> *watcher) {
+    auto it = m_inFlight.begin();
+    while (it != m_inFlight.end() && it->watcher != watcher) ++it;
+    if (it == m_inFlight.end()) {
+        watcher->deleteLater();
+        return;
+    }
+
+    RenderJob job = it->job;
+    job.elapsedMs = it->timer.nsecsElapsed() / 1e6;
+    bool canceled = it->canceled->load() == 1;
+    QImage image = canceled ? QImage() : watcher->result();
+    m_inFlight.erase(it);
+    watcher->deleteLater();
+
+    // Скользящее среднее времени от отправки задачи до готовой картинки.
+    if (canceled) {
+        ++m_canceled;
+    } else if (!image.isNull()) {
+        double &avg = m_avgRenderMs[job.quality == QualityDraft ? 0 : 1];
+        avg = avg == 0.0 ? job.elapsedMs : avg * 0.8 + job.elapsedMs * 0.2;
+        ++m_finished;
+    }
+
+    dispatch();
+    emit jobFinished(job, image);
+}
+
+QString RenderQueue::diskKey(const RenderJob &job, const DocumentPool *pool) {
+    QByteArray params = QByteArray::number(job.page) + ',' + QByteArray::number(job.tile)
+        + ',' + QByteArray::number(job.quality) + ',' + QByteArray::number(job.targetSize.width())
+        + 'x' + QByteArray::number(job.targetSize.height()) + ',' + QByteArray::number(job.dpr);
+    RenderProfile profile = pool->profile(job.quality == QualityDraft ? ProfileDraft : ProfileHD);
+    params += ',' + QByteArray::number(int(profile.backend)) + ',' + QByteArray::number(int(profile.hints))
+        + ',' + QByteArray::number(job.cacheKey.profile);
+    if (job.tile >= 0) {
+        const QRect &r = job.tileRect;
+        params += ',' + QByteArray::number(job.dpi) + ',' + QByteArray::number(r.x()) + ',' + QByteArray::number(r.y())
+            + ',' + QByteArray::number(r.width()) + ',' + QByteArray::number(r.height());
+    }
+    return DiskCache::keyFor(pool->fileIdentity(), params);
+}
+
+// Poppler опрашивает колбэк во время рендера, поэтому отменённая задача
+// освобождает поток, не дорисовывая тяжёлую страницу.
+#if defined(POPPLER_VERSION_MAJOR) && (POPPLER_VERSION_MAJOR > 0 || POPPLER_VERSION_MINOR >= 75)
+#define ORION_RENDER_ABORT
+static bool renderAborted(const QVariant &payload) {
+    const QAtomicInt *canceled = reinterpret_cast<const QAtomicInt*>(payload.value<quintptr>());
+    return canceled && canceled->load() == 1;
+}
+#endif
+
+static QImage renderPage(Poppler::Page *page, double dpi, const QRect &rect, const QAtomicInt *canceled) {
+#ifdef ORION_RENDER_ABORT
+    if (canceled) {
+        return page->renderToImage(dpi, dpi, rect.x(), rect.y(), rect.width(), rect.height(), Poppler::Page::Rotate0,
+                                   nullptr, nullptr, renderAborted, QVariant::fromValue(quintptr(canceled)));
+    }
+#else
+    Q_UNUSED(canceled);
+#endif
+    return page->renderToImage(dpi, dpi, rect.x(), rect.y(), rect.width(), rect.height());
+}
+
+QImage RenderQueue::render(const RenderJob &job, DocumentPool *pool, const QAtomicInt *canceled, DiskCache *diskCache) {
+    QImage img;
+    if (!pool) return img;
+    if (canceled && canceled->load() == 1) return img;
+
+    TraceSpan span(job.quality == QualityDraft ? "render draft" : "render hd", "render");
+    if (span.isActive()) span.setArgs(QJsonObject{{"page", job.page}, {"tile", job.tile}});
+
+    QString storeKey;
+    if (diskCache && diskCache->isEnabled()) {
+        storeKey = diskKey(job, pool);
+        img = diskCache->load(storeKey);
+        if (!img.isNull()) return img;
+    }
+
+    if (job.quality == QualityDraft) {
+        QThread::currentThread()->setPriority(QThread::HighestPriority);
+    } else {
+        QThread::currentThread()->setPriority(QThread::NormalPriority);
+    }
+
+    Poppler::Document *threadDoc = pool->acquire(job.quality == QualityDraft ? ProfileDraft : ProfileHD);
+    if (!threadDoc || job.page >= threadDoc->numPages()) return img;
+    if (canceled && canceled->load() == 1) return img;
+
+    Poppler::Page *p = threadDoc->page(job.page);
+    if (!p) return img;
+
+    if (job.tile >= 0) {
+        const QRect &r = job.tileRect;
+        img = renderPage(p, job.dpi, r, canceled);
+    } else {
+        double dpi;
+        if (job.quality == QualityDraft) {
+            dpi = DRAFT_DPI * job.dpr;
+        } else {
+            QSizeF pdfSize = p->pageSizeF();
+            double zoomFactor = double(job.targetSize.width()) / pdfSize.width();
+            dpi = 72.0 * zoomFactor * job.dpr;
+            if (dpi > MAX_DPI) dpi = MAX_DPI;
+        }
+        img = renderPage(p, dpi, QRect(-1, -1, -1, -1), canceled);
+    }
+    delete p;
+    if (canceled && canceled->load() == 1) return QImage();
+
+    // Готовим картинку к прямому выводу: непрозрачный формат и, для целой
+    // HD-страницы, ширина в пикселях устройства. Черновики не растягиваются:
+    // они дешёвые и малые, в том числе как подложка под тайлами.
+    // Высота берётся из пропорций отрисованной страницы, а не из оценки;
+    // если она расходится с раскладкой лишь округлением, картинка
+    // подгоняется точно под раскладку и выводится без масштабирования.
+    if (!img.isNull()) {
+        img = std::move(img).convertToFormat(QImage::Format_RGB32);
+        if (job.tile < 0 && job.quality == QualityHD) {
+            int deviceWidth = qRound(job.targetSize.width() * job.dpr);
+            int layoutHeight = qRound(job.targetSize.height() * job.dpr);
+            if (deviceWidth > 0) {
+                int deviceHeight = qMax(1, qRound(qint64(img.height()) * deviceWidth / double(img.width())));
+                if (layoutHeight > 0 && qAbs(deviceHeight - layoutHeight) <= 1) deviceHeight = layoutHeight;
+                if (img.size() != QSize(deviceWidth, deviceHeight)) {
+                    img = img.scaled(deviceWidth, deviceHeight, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+                }
+            }
+        }
+        if (job.tile < 0) img.setDevicePixelRatio(job.dpr);
+    }
+
+    if (!storeKey.isEmpty() && !(canceled && canceled->load() == 1)) {
+        diskCache->store(storeKey, img);
+    }
+    return img;
+}
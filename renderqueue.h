@@ -0,0 +1,104 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //renderqueue.h
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <QObject>
+#include <QImage>
+#include <QHash>
+#include <QList>
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include <QElapsedTimer>
+#include "documentpool.h"
+#include "diskcache.h"
+#include "pagecache.h"
+
+const double MAX_DPI = 400.0;
+const double DRAFT_DPI = 72.0;
+
+enum RenderQuality {
+    QualityDraft,
+    QualityHD
+};
+
+struct RenderJob {
+    int page = -1;
+    int tile = -1;
+    int quality = QualityDraft;
+    QSize targetSize;
+    QRect tileRect;
+    QSize imageSize;
+    double dpi = 0.0;
+    double dpr = 1.0;
+    int distance = 0;
+    double elapsedMs = 0.0;
+    quint64 traceId = 0;
+    PageCacheKey cacheKey;
+
+    qint64 id() const { return idFor(page, tile); }
+    static qint64 idFor(int page, int tile = -1) { return (qint64(page) << 32) | quint32(tile + 1); }
+};
+
+// Очередь рендера вьюпорта. В пул потоков уходит не больше maxInFlight задач,
+// остальные ждут в очереди, отсортированной по расстоянию до линии чтения,
+// и выбрасываются, если при следующем проходе они больше не нужны.
+class RenderQueue : public QObject {
+    Q_OBJECT
+public:
+    explicit RenderQueue(QObject *parent = nullptr);
+    ~RenderQueue();
+
+    void setDocumentPool(const QSharedPointer<DocumentPool> &pool);
+    void setMaxInFlight(int count);
+    void setDiskCache(DiskCache *cache);
+
+    void schedule(QList<RenderJob> jobs, int firstPage, int lastPage);
+    bool isInFlight(qint64 id) const;
+    void cancelAll();
+    void abandonAll();
+
+    int pendingCount() const { return m_pending.size(); }
+    int inFlightCount() const { return m_inFlight.size(); }
+    double averageRenderMs(int quality) const { return m_avgRenderMs[quality == QualityDraft ? 0 : 1]; }
+    quint64 finishedCount() const { return m_finished; }
+    quint64 canceledCount() const { return m_canceled; }
+
+    static QImage render(const RenderJob &job, DocumentPool *pool, const QAtomicInt *canceled = nullptr,
+                         DiskCache *diskCache = nullptr);
+    static QString diskKey(const RenderJob &job, const DocumentPool *pool);
+
+signals:
+    void jobFinished(const RenderJob &job, const QImage &image);
+
+private:
+    struct Running {
+        RenderJob job;
+        QFutureWatcher<QImage> *watcher = nullptr;
+        QSharedPointer<QAtomicInt> canceled;
+        QElapsedTimer timer;
+    };
+
+    void dispatch();
+    void onWatcherFinished(QFutureWatcher<QImage> *watcher);
+
+    QSharedPointer<DocumentPool> m_docPool;
+    DiskCache *m_diskCache = nullptr;
+    QList<RenderJob> m_pending;
+    QHash<qint64, Running> m_inFlight;
+    int m_maxInFlight;
+    double m_avgRenderMs[2] = { 0.0, 0.0 };
+    quint64 m_finished = 0;
+    quint64 m_canceled = 0;
+    quint64 m_traceSerial = 0;
+};
+
+#endif // RENDERQUEUE_H
@@ -0,0 +1,224 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //textindex.cpp
+#include "textindex.h"
+#include "documentpool.h"
+#include "tracer.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+
+static const quint32 INDEX_MAGIC = 0x4F525449; // "ORTI"
+static const quint16 INDEX_VERSION = 1;
+static const QDataStream::Version STREAM_VERSION = QDataStream::Qt_5_12;
+// Пустая страница в файле занимает минимум две длины по 4 байта.
+static const qint64 MIN_PAGE_BYTES = 8;
+// Рамки квантуются до 1/4 пункта в quint16: хватает для листов до 16383 pt.
+static const double BOX_SCALE = 4.0;
+
+static void packBox(QByteArray &out, const QRectF &r) {
+    quint16 v[4] = {
+        quint16(qBound(0.0, r.left() * BOX_SCALE, 65535.0)),
+        quint16(qBound(0.0, r.top() * BOX_SCALE, 65535.0)),
+        quint16(qBound(0.0, r.width() * BOX_SCALE + 0.5, 65535.0)),
+        quint16(qBound(0.0, r.height() * BOX_SCALE + 0.5, 65535.0))
+    };
+    for (quint16 &x : v) x = qToLittleEndian(x);
+    out.append(reinterpret_cast<const char*>(v), sizeof(v));
+}
+
+QString TextIndex::pageText(int page) const {
+    return (page >= 0 && page < m_pages.size()) ? m_pages[page].text : QString();
+}
+
+QVector<QRectF> TextIndex::charBoxes(int page) const {
+    QVector<QRectF> boxes;
+    if (page < 0 || page >= m_pages.size()) return boxes;
+    QByteArray raw = qUncompress(m_pages[page].packedBoxes);
+    int count = raw.size() / int(4 * sizeof(quint16));
+    boxes.reserve(count);
+    const uchar *p = reinterpret_cast<const uchar*>(raw.constData());
+    for (int i = 0; i < count; ++i, p += 8) {
+        boxes.append(QRectF(qFromLittleEndian<quint16>(p) / BOX_SCALE,
+                            qFromLittleEndian<quint16>(p + 2) / BOX_SCALE,
+                            qFromLittleEndian<quint16>(p + 4) / BOX_SCALE,
+                            qFromLittleEndian<quint16>(p + 6) / BOX_SCALE));
+    }
+    return boxes;
+}
+
+// Рамки символов совпадения объединяются построчно: символ начинает новую
+// строку, если его центр по вертикали вне текущего прямоугольника.
+QList<QRectF> TextIndex::rectsForRange(const QVector<QRectF> &boxes, int from, int length) {
+    QList<QRectF> rects;
+    QRectF current;
+    int end = qMin(from + length, boxes.size());
+    for (int i = qMax(0, from); i < end; ++i) {
+        const QRectF &b = boxes[i];
+        if (b.isEmpty()) continue;
+        double cy = b.center().y();
+        if (current.isNull()) {
+            current = b;
+        } else if (cy >= current.top() && cy <= current.bottom()) {
+            current = current.united(b);
+        } else {
+            rects.append(current);
+            current = b;
+        }
+    }
+    if (!current.isNull()) rects.append(current);
+    return rects;
+}
+
+QList<QRectF> TextIndex::find(int page, const TextMatcher &matcher) const {
+    QList<QRectF> result;
+    if (page < 0 || page >= m_pages.size()) return result;
+
+    const QVector<TextMatcher::Match> matches = matcher.findAll(m_pages[page].text);
+    if (matches.isEmpty()) return result;
+    const QVector<QRectF> boxes = charBoxes(page);
+    for (const TextMatcher::Match &m : matches) {
+        result += rectsForRange(boxes, m.offset, m.length);
+    }
+    return result;
+}
+
+// Слова склеиваются без пробела только если Poppler сообщает, что следующий
+// бокс продолжает то же слово; пробелам соответствует пустая рамка.
+void TextIndex::extractText(Poppler::Page *page, QString &text, QVector<QRectF> &boxes) {
+    text.clear();
+    boxes.clear();
+    QList<Poppler::TextBox*> words = page->textList();
+    for (int w = 0; w < words.size(); ++w) {
+        Poppler::TextBox *box = words[w];
+        const QString word = box->text();
+        for (int c = 0; c < word.size(); ++c) {
+            text.append(word[c]);
+            boxes.append(box->charBoundingBox(c));
+        }
+        bool last = w + 1 == words.size();
+        bool glued = !last && !box->hasSpaceAfter() && box->nextWord() == words[w + 1];
+        if (!last && !glued) {
+            text.append(QLatin1Char(' '));
+            boxes.append(QRectF());
+        }
+    }
+    qDeleteAll(words);
+}
+
+TextIndex::Page TextIndex::extractPage(Poppler::Page *page) {
+    Page result;
+    QVector<QRectF> boxes;
+    extractText(page, result.text, boxes);
+    QByteArray packed;
+    packed.reserve(boxes.size() * 8);
+    for (const QRectF &box : boxes) packBox(packed, box);
+    result.packedBoxes = qCompress(packed, 1);
+    return result;
+}
+
+static QString cacheDirectory() {
+    QString base = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (base.isEmpty()) base = QDir::tempPath();
+    return base + "/OrionCorp/PDFReader/text";
+}
+
+QString TextIndex::pathFor(const QByteArray &identity) {
+    QString hash = QString::fromLatin1(QCryptographicHash::hash(identity, QCryptographicHash::Sha1).toHex());
+    return cacheDirectory() + "/" + hash + ".idx";
+}
+
+// mtime индекса обновляется при каждой загрузке, поэтому при превышении
+// бюджета удаляются индексы давно не открывавшихся документов. Самый
+// свежий индекс остаётся, даже если он один больше бюджета.
+void TextIndex::trimCache(qint64 budget) {
+    QFileInfoList files = QDir(cacheDirectory()).entryInfoList(QStringList() << "*.idx", QDir::Files, QDir::Time);
+    qint64 used = 0;
+    for (int i = 0; i < files.size(); ++i) {
+        used += files[i].size();
+        if (i > 0 && used > budget) QFile::remove(files[i].absoluteFilePath());
+    }
+}
+
+QSharedPointer<TextIndex> TextIndex::load(const QByteArray &identity) {
+    QFile file(pathFor(identity));
+    if (!file.open(QIODevice::ReadOnly)) return QSharedPointer<TextIndex>();
+
+    QDataStream in(&file);
+    in.setVersion(STREAM_VERSION);
+    quint32 magic = 0;
+    quint16 version = 0;
+    QByteArray storedIdentity;
+    qint32 pages = 0;
+    in >> magic >> version >> storedIdentity >> pages;
+    if (in.status() != QDataStream::Ok || magic != INDEX_MAGIC || version != INDEX_VERSION
+            || storedIdentity != identity || pages < 0
+            || pages > (file.size() - file.pos()) / MIN_PAGE_BYTES) {
+        return QSharedPointer<TextIndex>();
+    }
+
+    QSharedPointer<TextIndex> index = QSharedPointer<TextIndex>::create();
+    index->m_pages.resize(pages);
+    for (Page &page : index->m_pages) {
+        in >> page.text >> page.packedBoxes;
+    }
+    if (in.status() != QDataStream::Ok) return QSharedPointer<TextIndex>();
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return index;
+}
+
+bool TextIndex::save(const QByteArray &identity) const {
+    QString path = pathFor(identity);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setVersion(STREAM_VERSION);
+    out << INDEX_MAGIC << INDEX_VERSION << identity << qint32(m_pages.size());
+    for (const Page &page : m_pages) {
+        out << page.text << page.packedBoxes;
+    }
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+QSharedPointer<TextIndex> TextIndex::build(Poppler::Document *doc, const QAtomicInt *canceled) {
+    QSharedPointer<TextIndex> index = QSharedPointer<TextIndex>::create();
+    int pages = doc->numPages();
+    index->m_pages.resize(pages);
+    for (int i = 0; i < pages; ++i) {
+        if (canceled && canceled->load() == 1) return QSharedPointer<TextIndex>();
+        Poppler::Page *page = doc->page(i);
+        if (!page) continue;
+        index->m_pages[i] = extractPage(page);
+        delete page;
+    }
+    return index;
+}
+
+// Строится на документе пула для текущего потока: задача держит пул через
+// QSharedPointer, и тот же документ потом служит поиску в этом потоке.
+QSharedPointer<TextIndex> TextIndex::loadOrBuild(DocumentPool *pool, const QAtomicInt *canceled) {
+    TraceSpan span("text index", "search");
+    QByteArray identity = pool->fileIdentity();
+    QSharedPointer<TextIndex> index = load(identity);
+    if (index) return index;
+
+    Poppler::Document *doc = pool->acquire();
+    if (!doc) return index;
+    index = build(doc, canceled);
+    if (index && index->save(identity)) trimCache(CacheBudget);
+    return index;
+}
@@ -0,0 +1,62 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //textindex.h
+#ifndef TEXTINDEX_H
+#define TEXTINDEX_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QList>
+#include <QRectF>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <poppler-qt5.h>
+#include "textmatcher.h"
+
+class DocumentPool;
+
+// Текст страниц документа с рамкой каждого символа (в пунктах), извлечённый
+// один раз через Page::textList и сохранённый на диск. Ключ файла индекса —
+// идентичность PDF (путь, размер, mtime), поэтому изменённый файл просто
+// не находит свой индекс и индексируется заново.
+// Рамки символов хранятся сжатыми и распаковываются только для страниц
+// с совпадениями. После построения объект только читается.
+// Файлы индексов вытесняются по давности использования в пределах CacheBudget.
+class TextIndex {
+public:
+    static const qint64 CacheBudget = 256ll * 1024 * 1024;
+
+    int pageCount() const { return m_pages.size(); }
+    QString pageText(int page) const;
+    QVector<QRectF> charBoxes(int page) const;
+
+    QList<QRectF> find(int page, const TextMatcher &matcher) const;
+    static QList<QRectF> rectsForRange(const QVector<QRectF> &boxes, int from, int length);
+    static void extractText(Poppler::Page *page, QString &text, QVector<QRectF> &boxes);
+
+    static QString pathFor(const QByteArray &identity);
+    static QSharedPointer<TextIndex> load(const QByteArray &identity);
+    static QSharedPointer<TextIndex> build(Poppler::Document *doc, const QAtomicInt *canceled);
+    static QSharedPointer<TextIndex> loadOrBuild(DocumentPool *pool, const QAtomicInt *canceled);
+    bool save(const QByteArray &identity) const;
+    static void trimCache(qint64 budget);
+
+private:
+    struct Page {
+        QString text;
+        QByteArray packedBoxes;
+    };
+
+    static Page extractPage(Poppler::Page *page);
+
+    QVector<Page> m_pages;
+};
+
+#endif // TEXTINDEX_H
@@ -0,0 +1,187 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //textmatcher.cpp
+#include "textmatcher.h"
+#include <QtAlgorithms>
+#include <QHash>
+#include <cstring>
+
+#if !defined(ORION_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ORION_SSE2
+#include <emmintrin.h>
+#endif
+
+// Первая позиция в [from, last], где стоит один из четырёх символов, либо -1.
+static int scanAnchor(const ushort *text, int from, int last, const ushort anchors[4]) {
+    int i = from;
+#ifdef ORION_SSE2
+    const __m128i va = _mm_set1_epi16(short(anchors[0]));
+    const __m128i vb = _mm_set1_epi16(short(anchors[1]));
+    const __m128i vc = _mm_set1_epi16(short(anchors[2]));
+    const __m128i vd = _mm_set1_epi16(short(anchors[3]));
+    for (; i + 8 <= last + 1; i += 8) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        __m128i eq = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(chunk, va), _mm_cmpeq_epi16(chunk, vb)),
+                                  _mm_or_si128(_mm_cmpeq_epi16(chunk, vc), _mm_cmpeq_epi16(chunk, vd)));
+        int mask = _mm_movemask_epi8(eq);
+        if (mask) return i + int(qCountTrailingZeroBits(quint32(mask)) >> 1);
+    }
+#endif
+    for (; i <= last; ++i) {
+        ushort c = text[i];
+        if (c == anchors[0] || c == anchors[1] || c == anchors[2] || c == anchors[3]) return i;
+    }
+    return -1;
+}
+
+static inline ushort foldCase(ushort c) {
+    return c < 0x80 ? ushort(c >= 'A' && c <= 'Z' ? c + 32 : c) : QChar(c).toCaseFolded().unicode();
+}
+
+// Все символы BMP с данной свёрткой регистра. Пар «строчная — заглавная»
+// мало: «s» сворачивают ещё и «ſ», «σ» — «Σ» и «ς», «k» — знак кельвина.
+// Таблица строится один раз на процесс.
+static QVector<ushort> caseVariants(ushort folded) {
+    static const QHash<ushort, QVector<ushort>> table = []() {
+        QHash<ushort, QVector<ushort>> variants;
+        for (uint c = 0x80; c < 0x10000; ++c) {
+            if (QChar::isSurrogate(c)) continue;
+            ushort f = foldCase(ushort(c));
+            if (f != c) variants[f].append(ushort(c));
+        }
+        return variants;
+    }();
+    QVector<ushort> result;
+    result.append(folded);
+    if (folded >= 'a' && folded <= 'z') result.append(ushort(folded - 32));
+    result += table.value(folded);
+    return result;
+}
+
+int TextMatcher::indexOfLiteral(const QString &text, const QString &needle, int from, Qt::CaseSensitivity cs) {
+    const int n = text.size();
+    const int m = needle.size();
+    if (m == 0 || from < 0 || n - from < m) return -1;
+
+    const ushort *hay = text.utf16();
+    const ushort *pat = needle.utf16();
+    const int last = n - m;
+
+    if (cs == Qt::CaseSensitive) {
+        const ushort anchors[4] = { pat[0], pat[0], pat[0], pat[0] };
+        for (int pos = from; pos <= last; ++pos) {
+            pos = scanAnchor(hay, pos, last, anchors);
+            if (pos < 0) return -1;
+            if (std::memcmp(hay + pos + 1, pat + 1, size_t(m - 1) * sizeof(ushort)) == 0) return pos;
+        }
+        return -1;
+    }
+
+    QVector<ushort> folded(m);
+    for (int k = 0; k < m; ++k) folded[k] = foldCase(pat[k]);
+
+    // Якорь — все символы, чья свёртка совпадает со свёрткой первого
+    // символа образца; больше четырёх таких символов не бывает, но на этот
+    // случай есть посимвольный обход со свёрткой.
+    const QVector<ushort> variants = caseVariants(folded[0]);
+    ushort anchors[4];
+    for (int k = 0; k < 4; ++k) anchors[k] = variants[qMin(k, variants.size() - 1)];
+
+    for (int pos = from; pos <= last; ++pos) {
+        if (variants.size() <= 4) {
+            pos = scanAnchor(hay, pos, last, anchors);
+            if (pos < 0) return -1;
+        } else if (foldCase(hay[pos]) != folded[0]) {
+            continue;
+        }
+        int k = 1;
+        while (k < m && foldCase(hay[pos + k]) == folded[k]) ++k;
+        if (k == m) return pos;
+    }
+    return -1;
+}
+
+// Символ заменяется первой буквой своего канонического разложения
+// («é» → «e», «ё» → «е»), поэтому длина текста не меняется.
+QString TextMatcher::foldDiacritics(const QString &text) {
+    QString out = text;
+    QChar *data = out.data();
+    for (int i = 0; i < out.size(); ++i) {
+        QChar c = data[i];
+        if (c.unicode() < 0xC0 || c.isSurrogate()) continue;
+        while (c.decompositionTag() == QChar::Canonical) {
+            QString d = c.decomposition();
+            if (d.isEmpty() || d[0].isSurrogate()) break;
+            c = d[0];
+        }
+        data[i] = c;
+    }
+    return out;
+}
+
+TextMatcher::TextMatcher(const QString &pattern, Options options)
+    : m_pattern(pattern), m_options(options) {
+    m_needle = (options & IgnoreDiacritics) ? foldDiacritics(pattern) : pattern;
+    if (options & RegularExpression) {
+        QRegularExpression::PatternOptions flags = QRegularExpression::UseUnicodePropertiesOption;
+        if (!(options & CaseSensitive)) flags |= QRegularExpression::CaseInsensitiveOption;
+        QString source = (options & WholeWords) ? "\\b(?:" + m_needle + ")\\b" : m_needle;
+        m_regex = QRegularExpression(source, flags);
+        m_regex.optimize();
+    }
+}
+
+bool TextMatcher::isValid() const {
+    if (m_pattern.isEmpty()) return false;
+    return !(m_options & RegularExpression) || m_regex.isValid();
+}
+
+QString TextMatcher::errorString() const {
+    return (m_options & RegularExpression) ? m_regex.errorString() : QString();
+}
+
+// Граница проверяется только со стороны буквы или цифры образца:
+// образец «-12» совпадает и внутри «AB-12».
+bool TextMatcher::isWordAt(const QString &text, int offset, int length) const {
+    if (length <= 0) return false;
+    int end = offset + length;
+    if (text[offset].isLetterOrNumber() && offset > 0 && text[offset - 1].isLetterOrNumber()) return false;
+    if (text[end - 1].isLetterOrNumber() && end < text.size() && text[end].isLetterOrNumber()) return false;
+    return true;
+}
+
+QVector<TextMatcher::Match> TextMatcher::findAll(const QString &text) const {
+    QVector<Match> matches;
+    if (!isValid() || text.isEmpty()) return matches;
+
+    const QString folded = (m_options & IgnoreDiacritics) ? foldDiacritics(text) : QString();
+    const QString &haystack = (m_options & IgnoreDiacritics) ? folded : text;
+
+    if (m_options & RegularExpression) {
+        QRegularExpressionMatchIterator it = m_regex.globalMatch(haystack);
+        while (it.hasNext()) {
+            QRegularExpressionMatch match = it.next();
+            if (match.capturedLength() > 0) matches.append(Match{match.capturedStart(), match.capturedLength()});
+        }
+        return matches;
+    }
+
+    Qt::CaseSensitivity cs = (m_options & CaseSensitive) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    const int length = m_needle.size();
+    int pos = indexOfLiteral(haystack, m_needle, 0, cs);
+    while (pos >= 0) {
+        if (!(m_options & WholeWords) || isWordAt(haystack, pos, length)) {
+            matches.append(Match{pos, length});
+            pos = indexOfLiteral(haystack, m_needle, pos + length, cs);
+        } else {
+            pos = indexOfLiteral(haystack, m_needle, pos + 1, cs);
+        }
+    }
+    return matches;
+}
@@ -0,0 +1,63 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //textmatcher.h
+#ifndef TEXTMATCHER_H
+#define TEXTMATCHER_H
+
+#include <QString>
+#include <QVector>
+#include <QFlags>
+#include <QRegularExpression>
+
+// Поиск совпадений в тексте страницы. Результат — смещения в исходном
+// тексте, поэтому их можно сопоставить рамкам символов из TextIndex.
+// Литеральный поиск ищет первый символ образца во всех вариантах его
+// регистра блоками по 8 символов (SSE2, если доступно; ORION_NO_SIMD
+// отключает) и проверяет кандидатов целиком; свёртка
+// диакритики заменяет символ один к одному и не сдвигает смещения.
+class TextMatcher {
+public:
+    enum Option {
+        CaseSensitive = 0x1,
+        WholeWords = 0x2,
+        IgnoreDiacritics = 0x4,
+        RegularExpression = 0x8
+    };
+    Q_DECLARE_FLAGS(Options, Option)
+
+    struct Match {
+        int offset;
+        int length;
+    };
+
+    TextMatcher() = default;
+    TextMatcher(const QString &pattern, Options options);
+
+    bool isValid() const;
+    QString errorString() const;
+    QString pattern() const { return m_pattern; }
+    Options options() const { return m_options; }
+
+    QVector<Match> findAll(const QString &text) const;
+
+    static QString foldDiacritics(const QString &text);
+    static int indexOfLiteral(const QString &text, const QString &needle, int from, Qt::CaseSensitivity cs);
+
+private:
+    bool isWordAt(const QString &text, int offset, int length) const;
+
+    QString m_pattern;
+    QString m_needle;
+    Options m_options;
+    QRegularExpression m_regex;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(TextMatcher::Options)
+
+#endif // TEXTMATCHER_H
@@ -0,0 +1,150 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //thumbnailrenderer.cpp
+#include "thumbnailrenderer.h"
+#include "tracer.h"
+#include <QTimer>
+#include <QtConcurrent>
+
+// Стоимость в килобайтах, как и в PageCache.
+ThumbnailRenderer::ThumbnailRenderer(QObject *parent) : QObject(parent) {
+    m_cache.setMaxCost(48 * 1024);
+    m_canceled = QSharedPointer<QAtomicInt>::create(0);
+}
+
+ThumbnailRenderer::~ThumbnailRenderer() {
+    abandonAll();
+}
+
+void ThumbnailRenderer::setDocumentPool(const QSharedPointer<DocumentPool> &pool) {
+    cancelAll();
+    m_cache.clear();
+    m_docPool = pool;
+}
+
+void ThumbnailRenderer::setDevicePixelRatio(double dpr) {
+    if (qFuzzyCompare(dpr, m_dpr)) return;
+    cancelAll();
+    m_cache.clear();
+    m_dpr = dpr;
+}
+
+QPixmap ThumbnailRenderer::thumbnail(int page) {
+    QPixmap *pix = m_cache.object(page);
+    return pix ? *pix : QPixmap();
+}
+
+// Последние запрошенные страницы рендерятся первыми; при быстрой прокрутке
+// старые запросы вытесняются из очереди.
+void ThumbnailRenderer::request(int page) {
+    if (!m_docPool || page < 0 || m_inFlight.contains(page) || m_cache.contains(page)) return;
+    m_pending.removeOne(page);
+    m_pending.append(page);
+    while (m_pending.size() > MaxPending) m_pending.removeFirst();
+
+    if (!m_dispatchScheduled) {
+        m_dispatchScheduled = true;
+        QTimer::singleShot(0, this, [this]() {
+            m_dispatchScheduled = false;
+            dispatch();
+        });
+    }
+}
+
+void ThumbnailRenderer::cancelAll() {
+    m_pending.clear();
+    m_inFlight.clear();
+    m_canceled->store(1);
+    m_canceled = QSharedPointer<QAtomicInt>::create(0);
+}
+
+void ThumbnailRenderer::abandonAll() {
+    cancelAll();
+    for (auto it = m_watchers.begin(); it != m_watchers.end(); ++it) {
+        it.key()->disconnect();
+        it.key()->deleteLater();
+    }
+    m_watchers.clear();
+}
+
+void ThumbnailRenderer::dispatch() {
+    while (m_watchers.size() < MaxInFlight && !m_pending.isEmpty() && m_docPool) {
+        QVector<int> pages;
+        while (pages.size() < BatchSize && !m_pending.isEmpty()) {
+            int page = m_pending.takeLast();
+            m_inFlight.insert(page);
+            pages.append(page);
+        }
+
+        QFutureWatcher<Batch> *watcher = new QFutureWatcher<Batch>(this);
+        connect(watcher, &QFutureWatcher<Batch>::finished, this, [this, watcher]() {
+            onBatchFinished(watcher);
+        });
+        m_watchers.insert(watcher, m_canceled);
+
+        QSharedPointer<DocumentPool> pool = m_docPool;
+        QSharedPointer<QAtomicInt> canceled = m_canceled;
+        double dpr = m_dpr;
+        watcher->setFuture(QtConcurrent::run([pages, pool, canceled, dpr]() {
+            return ThumbnailRenderer::renderBatch(pages, pool.data(), dpr, canceled.data());
+        }));
+    }
+}
+
+void ThumbnailRenderer::onBatchFinished(QFutureWatcher<Batch> *watcher) {
+    QSharedPointer<QAtomicInt> canceled = m_watchers.take(watcher);
+    watcher->deleteLater();
+
+    if (canceled && canceled->load() == 0) {
+        const Batch batch = watcher->result();
+        for (const QPair<int, QImage> &item : batch) {
+            m_inFlight.remove(item.first);
+            if (item.second.isNull()) continue;
+            QPixmap *pix = new QPixmap(QPixmap::fromImage(item.second));
+            int cost = qMax(1, int(qint64(pix->width()) * pix->height() * pix->depth() / 8 / 1024));
+            m_cache.insert(item.first, pix, cost);
+            emit thumbnailReady(item.first);
+        }
+    }
+
+    dispatch();
+}
+
+ThumbnailRenderer::Batch ThumbnailRenderer::renderBatch(const QVector<int> &pages, DocumentPool *pool,
+                                                        double dpr, const QAtomicInt *canceled) {
+    TraceSpan span("thumbnail batch", "render");
+    if (span.isActive()) span.setArgs(QJsonObject{{"pages", pages.size()}});
+    Batch batch;
+    if (!pool) return batch;
+    Poppler::Document *threadDoc = pool->acquire(ProfileThumbnail);
+    if (!threadDoc) return batch;
+
+    int targetW = qRound(ThumbWidth * dpr);
+    for (int page : pages) {
+        QImage img;
+        if (canceled->load() == 0 && page < threadDoc->numPages()) {
+            Poppler::Page *p = threadDoc->page(page);
+            if (p) {
+                QSizeF size = p->pageSizeF();
+                double dpi = size.width() > 0 ? 72.0 * targetW / size.width() : 72.0;
+                img = p->renderToImage(dpi, dpi);
+                delete p;
+            }
+        }
+        if (!img.isNull()) {
+            if (img.width() != targetW) {
+                img = img.scaledToWidth(targetW, Qt::SmoothTransformation);
+            }
+            img = img.convertToFormat(QImage::Format_RGB32);
+            img.setDevicePixelRatio(dpr);
+        }
+        batch.append(qMakePair(page, img));
+    }
+    return batch;
+}
@@ -0,0 +1,69 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //thumbnailrenderer.h
+#ifndef THUMBNAILRENDERER_H
+#define THUMBNAILRENDERER_H
+
+#include <QObject>
+#include <QCache>
+#include <QPixmap>
+#include <QImage>
+#include <QList>
+#include <QSet>
+#include <QHash>
+#include <QVector>
+#include <QPair>
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include "documentpool.h"
+
+// Отдельный конвейер миниатюр: низкое разрешение, несколько страниц на одну
+// задачу пула и собственный небольшой кэш. С очередью и кэшем полноразмерного
+// рендера не пересекается.
+class ThumbnailRenderer : public QObject {
+    Q_OBJECT
+public:
+    static const int ThumbWidth = 160;
+    static const int BatchSize = 12;
+    static const int MaxPending = 96;
+    static const int MaxInFlight = 2;
+
+    explicit ThumbnailRenderer(QObject *parent = nullptr);
+    ~ThumbnailRenderer();
+
+    void setDocumentPool(const QSharedPointer<DocumentPool> &pool);
+    void setDevicePixelRatio(double dpr);
+
+    QPixmap thumbnail(int page);
+    void request(int page);
+    void cancelAll();
+    void abandonAll();
+
+signals:
+    void thumbnailReady(int page);
+
+private:
+    typedef QVector<QPair<int, QImage>> Batch;
+
+    void dispatch();
+    void onBatchFinished(QFutureWatcher<Batch> *watcher);
+    static Batch renderBatch(const QVector<int> &pages, DocumentPool *pool, double dpr, const QAtomicInt *canceled);
+
+    QSharedPointer<DocumentPool> m_docPool;
+    QCache<int, QPixmap> m_cache;
+    QList<int> m_pending;
+    QSet<int> m_inFlight;
+    QHash<QFutureWatcher<Batch>*, QSharedPointer<QAtomicInt>> m_watchers;
+    QSharedPointer<QAtomicInt> m_canceled;
+    double m_dpr = 1.0;
+    bool m_dispatchScheduled = false;
+};
+
+#endif // THUMBNAILRENDERER_H
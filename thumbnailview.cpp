@@ -0,0 +1,116 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //thumbnailview.cpp
+#include "thumbnailview.h"
+#include <QStyledItemDelegate>
+#include <QPainter>
+
+const double THUMB_ASPECT = 1.414;
+const int THUMB_MARGIN = 8;
+
+class ThumbnailDelegate : public QStyledItemDelegate {
+public:
+    ThumbnailDelegate(ThumbnailRenderer *renderer, ThumbnailView *view)
+        : QStyledItemDelegate(view), m_renderer(renderer), m_view(view) {}
+
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &) const override {
+        int w = m_view->thumbWidth();
+        return QSize(w + THUMB_MARGIN * 2, qRound(w * THUMB_ASPECT) + THUMB_MARGIN * 2 + option.fontMetrics.height());
+    }
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override {
+        int page = index.row();
+        int w = m_view->thumbWidth();
+        QRect cell = option.rect;
+
+        if (option.state & QStyle::State_Selected) {
+            painter->fillRect(cell.adjusted(2, 2, -2, -2), QColor(66, 133, 244, 90));
+        }
+
+        QRect area(cell.left() + (cell.width() - w) / 2, cell.top() + THUMB_MARGIN, w, qRound(w * THUMB_ASPECT));
+        QPixmap pix = m_renderer->thumbnail(page);
+        QRect target = area;
+        if (pix.isNull()) {
+            m_renderer->request(page);
+            painter->fillRect(area, QColor(235, 235, 235));
+        } else {
+            QSizeF logical = QSizeF(pix.size()) / pix.devicePixelRatio();
+            QSize fitted = logical.scaled(area.size(), Qt::KeepAspectRatio).toSize();
+            target = QRect(area.left() + (area.width() - fitted.width()) / 2, area.top(), fitted.width(), fitted.height());
+            painter->setRenderHint(QPainter::SmoothPixmapTransform, fitted != logical.toSize());
+            painter->drawPixmap(target, pix);
+        }
+        painter->setPen(QColor(180, 180, 180));
+        painter->drawRect(target.adjusted(0, 0, -1, -1));
+
+        painter->setPen(option.palette.color(QPalette::Text));
+        QRect label(cell.left(), area.bottom() + 2, cell.width(), option.fontMetrics.height());
+        painter->drawText(label, Qt::AlignCenter, QString::number(page + 1));
+    }
+
+private:
+    ThumbnailRenderer *m_renderer;
+    ThumbnailView *m_view;
+};
+
+ThumbnailView::ThumbnailView(ThumbnailRenderer *renderer, QWidget *parent)
+    : QListWidget(parent), m_renderer(renderer)
+{
+    setItemDelegate(new ThumbnailDelegate(renderer, this));
+    setUniformItemSizes(true);
+    setSelectionMode(QAbstractItemView::SingleSelection);
+    setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setGridMode(false);
+
+    connect(m_renderer, &ThumbnailRenderer::thumbnailReady, this, &ThumbnailView::onThumbnailReady);
+    connect(this, &QListWidget::itemClicked, this, [this](QListWidgetItem *item) {
+        emit pageActivated(row(item) + 1);
+    });
+}
+
+void ThumbnailView::setPageCount(int count) {
+    clear();
+    for (int i = 0; i < count; ++i) {
+        addItem(new QListWidgetItem());
+    }
+}
+
+void ThumbnailView::setGridMode(bool grid) {
+    m_gridMode = grid;
+    m_thumbWidth = grid ? ThumbnailRenderer::ThumbWidth : 110;
+    setViewMode(QListView::IconMode);
+    setMovement(QListView::Static);
+    setResizeMode(QListView::Adjust);
+    setFlow(grid ? QListView::LeftToRight : QListView::TopToBottom);
+    setWrapping(grid);
+    setSpacing(grid ? 6 : 2);
+    if (grid) {
+        setStyleSheet("QListWidget { background-color: #525659; color: white; border: none; }");
+        setMinimumWidth(0);
+        setMaximumWidth(QWIDGETSIZE_MAX);
+    } else {
+        setStyleSheet("QListWidget { background: #f5f5f5; border: none; border-right: 1px solid #ddd; }");
+        setFixedWidth(m_thumbWidth + 2 * THUMB_MARGIN + 24);
+    }
+    doItemsLayout();
+}
+
+void ThumbnailView::setCurrentPage(int page) {
+    if (page < 1 || page > count()) return;
+    blockSignals(true);
+    setCurrentRow(page - 1);
+    blockSignals(false);
+    scrollToItem(item(page - 1));
+}
+
+void ThumbnailView::onThumbnailReady(int page) {
+    QListWidgetItem *it = item(page);
+    if (it) viewport()->update(visualItemRect(it));
+}
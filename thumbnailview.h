@@ -0,0 +1,42 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //thumbnailview.h
+#ifndef THUMBNAILVIEW_H
+#define THUMBNAILVIEW_H
+
+#include <QListWidget>
+#include "thumbnailrenderer.h"
+
+// Лента миниатюр (вертикальная полоса) или сетка обзора документа.
+// Миниатюры запрашиваются делегатом при отрисовке, то есть только для
+// видимых ячеек.
+class ThumbnailView : public QListWidget {
+    Q_OBJECT
+public:
+    explicit ThumbnailView(ThumbnailRenderer *renderer, QWidget *parent = nullptr);
+
+    void setPageCount(int count);
+    void setGridMode(bool grid);
+    bool isGridMode() const { return m_gridMode; }
+    void setCurrentPage(int page);
+    int thumbWidth() const { return m_thumbWidth; }
+
+signals:
+    void pageActivated(int page);
+
+private slots:
+    void onThumbnailReady(int page);
+
+private:
+    ThumbnailRenderer *m_renderer;
+    bool m_gridMode = false;
+    int m_thumbWidth = 110;
+};
+
+#endif // THUMBNAILVIEW_H
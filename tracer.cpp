@@ -0,0 +1,175 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //tracer.cpp
+#include "tracer.h"
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <utility>
+
+static QAtomicInt s_enabled(0);
+static QAtomicInt s_nextThreadId(0);
+// События копятся пачками и дописываются в открытый файл, поэтому память
+// не растёт с длиной сеанса. Порядок пачек в файле не важен: просмотрщик
+// сортирует события по ts.
+static const int FLUSH_EVENTS = 4096;
+
+static QMutex s_mutex;
+static QVector<QByteArray> s_events;
+static QMutex s_fileMutex;
+static QFile *s_file = nullptr;
+static bool s_firstEvent = true;
+static QElapsedTimer s_clock;
+
+static void writeEvents(const QVector<QByteArray> &events) {
+    QMutexLocker locker(&s_fileMutex);
+    if (!s_file) return;
+    for (const QByteArray &event : events) {
+        if (!s_firstEvent) s_file->write(",\n");
+        s_file->write(event);
+        s_firstEvent = false;
+    }
+}
+
+bool Tracer::isEnabled() {
+    return s_enabled.loadAcquire() != 0;
+}
+
+void Tracer::start(const QString &path) {
+    if (path.isEmpty() || isEnabled()) return;
+    {
+        QMutexLocker locker(&s_fileMutex);
+        QFile *file = new QFile(path);
+        if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            delete file;
+            return;
+        }
+        file->write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        s_file = file;
+        s_firstEvent = true;
+    }
+    QMutexLocker locker(&s_mutex);
+    s_events.clear();
+    s_events.reserve(FLUSH_EVENTS);
+    s_clock.start();
+    s_enabled.storeRelease(1);
+}
+
+void Tracer::stop() {
+    if (!isEnabled()) return;
+    s_enabled.storeRelease(0);
+
+    QVector<QByteArray> rest;
+    {
+        QMutexLocker locker(&s_mutex);
+        rest.swap(s_events);
+    }
+    writeEvents(rest);
+
+    QMutexLocker locker(&s_fileMutex);
+    s_file->write("\n]}\n");
+    delete s_file;
+    s_file = nullptr;
+}
+
+QString Tracer::pathFromEnvironment(const QStringList &arguments) {
+    int index = arguments.indexOf("--trace");
+    if (index >= 0) {
+        QString next = arguments.value(index + 1);
+        return (next.isEmpty() || next.startsWith('-')) ? QString("orion-trace.json") : next;
+    }
+    QString env = qEnvironmentVariable("ORION_TRACE");
+    if (env.isEmpty() || env == "0") return QString();
+    return env == "1" ? QString("orion-trace.json") : env;
+}
+
+qint64 Tracer::nowUs() {
+    return s_clock.nsecsElapsed() / 1000;
+}
+
+QByteArray Tracer::args(const QJsonObject &object) {
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+// Короткие номера потоков вместо адресов QThread; при первом событии потока
+// пишется метаданное thread_name, чтобы просмотрщик подписал дорожку.
+int Tracer::threadId() {
+    static thread_local int tid = 0;
+    if (tid == 0) {
+        tid = s_nextThreadId.fetchAndAddRelaxed(1) + 1;
+        QThread *thread = QThread::currentThread();
+        QString name = thread->objectName();
+        if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) name = "GUI";
+        if (name.isEmpty()) name = QString("worker %1").arg(tid);
+        QByteArray meta = "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + QByteArray::number(tid)
+            + ",\"args\":" + args(QJsonObject{{"name", name}}) + "}";
+        append(meta);
+    }
+    return tid;
+}
+
+void Tracer::append(QByteArray event) {
+    QVector<QByteArray> full;
+    {
+        QMutexLocker locker(&s_mutex);
+        s_events.append(std::move(event));
+        if (s_events.size() < FLUSH_EVENTS) return;
+        full.swap(s_events);
+        s_events.reserve(FLUSH_EVENTS);
+    }
+    writeEvents(full);
+}
+
+void Tracer::complete(const char *name, const char *category, qint64 startUs, qint64 durationUs, const QByteArray &args) {
+    if (!isEnabled()) return;
+    QByteArray event = "{\"name\":\"" + QByteArray(name) + "\",\"cat\":\"" + QByteArray(category)
+        + "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + QByteArray::number(threadId())
+        + ",\"ts\":" + QByteArray::number(startUs) + ",\"dur\":" + QByteArray::number(durationUs);
+    if (!args.isEmpty()) event += ",\"args\":" + args;
+    event += '}';
+    append(std::move(event));
+}
+
+void Tracer::asyncBegin(const char *name, const char *category, quint64 id, const QByteArray &args) {
+    if (!isEnabled()) return;
+    QByteArray event = "{\"name\":\"" + QByteArray(name) + "\",\"cat\":\"" + QByteArray(category)
+        + "\",\"ph\":\"b\",\"pid\":1,\"tid\":" + QByteArray::number(threadId())
+        + ",\"id\":" + QByteArray::number(id) + ",\"ts\":" + QByteArray::number(nowUs());
+    if (!args.isEmpty()) event += ",\"args\":" + args;
+    event += '}';
+    append(std::move(event));
+}
+
+void Tracer::asyncEnd(const char *name, const char *category, quint64 id, const QByteArray &args) {
+    if (!isEnabled()) return;
+    QByteArray event = "{\"name\":\"" + QByteArray(name) + "\",\"cat\":\"" + QByteArray(category)
+        + "\",\"ph\":\"e\",\"pid\":1,\"tid\":" + QByteArray::number(threadId())
+        + ",\"id\":" + QByteArray::number(id) + ",\"ts\":" + QByteArray::number(nowUs());
+    if (!args.isEmpty()) event += ",\"args\":" + args;
+    event += '}';
+    append(std::move(event));
+}
+
+TraceSpan::TraceSpan(const char *name, const char *category) : m_name(name), m_category(category) {
+    if (Tracer::isEnabled()) m_start = Tracer::nowUs();
+}
+
+TraceSpan::~TraceSpan() {
+    if (m_start < 0) return;
+    Tracer::complete(m_name, m_category, m_start, Tracer::nowUs() - m_start, m_args);
+}
+
+void TraceSpan::setArgs(const QJsonObject &args) {
+    if (m_start >= 0) m_args = Tracer::args(args);
+}
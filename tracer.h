@@ -0,0 +1,60 @@
+/*
+ * PDF Reader
+ * Copyright (c) 2026 [Muzon4ik]
+ *
+ * Restricted License:
+ * This project is for portfolio demonstration and educational use only.
+ * Commercial use, resale, or distribution for profit is strictly prohibited.
+ */
+ //tracer.h
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QJsonObject>
+
+// Запись интервалов в формате Chrome trace-event (chrome://tracing, Perfetto).
+// Включается переменной окружения ORION_TRACE=<файл> или ключом --trace [файл];
+// выключенный трассировщик стоит одну атомарную проверку на интервал;
+// события пишутся в файл пачками по ходу сеанса, память не растёт.
+class Tracer {
+public:
+    static bool isEnabled();
+    static void start(const QString &path);
+    static void stop();
+    static QString pathFromEnvironment(const QStringList &arguments);
+
+    static qint64 nowUs();
+    static void complete(const char *name, const char *category, qint64 startUs, qint64 durationUs,
+                         const QByteArray &args = QByteArray());
+    static void asyncBegin(const char *name, const char *category, quint64 id, const QByteArray &args = QByteArray());
+    static void asyncEnd(const char *name, const char *category, quint64 id, const QByteArray &args = QByteArray());
+    static QByteArray args(const QJsonObject &object);
+
+private:
+    static void append(QByteArray event);
+    static int threadId();
+};
+
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name, const char *category = "app");
+    ~TraceSpan();
+
+    // Аргументы собираются только под isActive(): иначе QJsonObject строится
+    // на каждом вызове и при выключенной трассировке.
+    bool isActive() const { return m_start >= 0; }
+    void setArgs(const QJsonObject &args);
+
+private:
+    Q_DISABLE_COPY(TraceSpan)
+
+    const char *m_name;
+    const char *m_category;
+    qint64 m_start = -1;
+    QByteArray m_args;
+};
+
+#endif // TRACER_H